@@ -0,0 +1,67 @@
+#include "Dictionary.hpp"
+
+#include "WordTree.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+std::shared_ptr<WordTree> readDictionary(std::string filename)
+{
+    auto wordTree = std::make_shared<WordTree>();
+    std::ifstream inFile = std::ifstream(filename, std::ios::in);
+    if (!inFile)
+    {
+        throw std::runtime_error("Cannot open dictionary " + filename);
+    }
+
+    while (!inFile.eof())
+    {
+        std::string word;
+        std::getline(inFile, word);
+        // Need to consume the carriage return character for some systems, if it exists
+        if (!word.empty() && word[word.size() - 1] == '\r')
+        {
+            word.erase(word.end() - 1);
+        }
+        // A word may be followed by a tab and how often it is used, which becomes its score
+        std::uint32_t score = 0;
+        std::size_t tab = word.find('\t');
+        if (tab != std::string::npos)
+        {
+            std::string count = word.substr(tab + 1);
+            word.erase(tab);
+            if (count.empty() || !std::all_of(count.begin(), count.end(), [](unsigned char c) { return std::isdigit(c); }))
+            {
+                continue;
+            }
+            // Counts too large for a score all share the highest one
+            std::uint64_t value = 0;
+            for (char digit : count)
+            {
+                value = std::min<std::uint64_t>(value * 10 + static_cast<std::uint64_t>(digit - '0'), std::numeric_limits<std::uint32_t>::max());
+            }
+            score = static_cast<std::uint32_t>(value);
+        }
+        // Keep only if everything is an alphabetic character -- Have to send isalpha an unsigned char or
+        // it will throw exception on negative values; e.g., characters with accent marks.
+        if (std::all_of(word.begin(), word.end(), [](unsigned char c)
+                        {
+                            return std::isalpha(c);
+                        }))
+        {
+            std::transform(word.begin(), word.end(), word.begin(), [](char c)
+                           {
+                               return static_cast<char>(std::tolower(c));
+                           });
+            wordTree->add(word, score);
+        }
+    }
+
+    return wordTree;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "WordTree.hpp"
+
+#include <memory>
+#include <string>
+
+// Reads a word list with one word per line, keeping only the words made entirely of letters. A
+// word may be followed by a tab and a count, such as "the\t23135851162", which becomes its score
+// so common words are predicted first; lines with a count that is not a number are skipped.
+// Throws std::runtime_error when the file cannot be opened.
+std::shared_ptr<WordTree> readDictionary(std::string filename);
@@ -1,7 +1,13 @@
+#include "Dictionary.hpp"
+#include "WordGraph.hpp"
 #include "WordTree.hpp"
 
 #include <algorithm>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
 
 int main(int argc, char* argv[])
 {
@@ -391,4 +397,437 @@ TEST(WordTree_Predict, CorrectBreadthFirstPredictions)
     EXPECT_EQ("exits", predictions[3]);
     EXPECT_EQ("extra", predictions[4]);
     EXPECT_EQ("excite", predictions[5]);
-}
\ No newline at end of file
+}
+
+TEST(WordTree_Add, CanAddManyWordsWithSharedPrefixes)
+{
+    WordTree wordTree;
+
+    // Every word of one to four letters from a to f, so most nodes are shared by many words
+    std::vector<std::string> words;
+    for (std::size_t length = 1; length <= 4; length++)
+    {
+        std::string word(length, 'a');
+        while (true)
+        {
+            words.push_back(word);
+            std::size_t i = length;
+            while (i > 0 && word[i - 1] == 'f')
+            {
+                word[--i] = 'a';
+            }
+            if (i == 0)
+            {
+                break;
+            }
+            word[i - 1]++;
+        }
+    }
+    for (const auto& word : words)
+    {
+        wordTree.add(word);
+    }
+
+    EXPECT_EQ(6 + 36 + 216 + 1296, wordTree.size());
+    for (const auto& word : words)
+    {
+        EXPECT_TRUE(wordTree.find(word));
+    }
+    EXPECT_FALSE(wordTree.find("aaaaa"));
+    EXPECT_FALSE(wordTree.find("g"));
+
+    const auto predictions = wordTree.predict("fff", 10);
+
+    EXPECT_EQ(6, predictions.size());
+    EXPECT_EQ("fffa", predictions[0]);
+    EXPECT_EQ("ffff", predictions[5]);
+}
+
+TEST(WordTree_Predict, KeepsLetterOrderWhateverTheInsertOrder)
+{
+    WordTree wordTree;
+
+    // Each new letter lands before, between or after the children a node already has
+    wordTree.add("cz");
+    wordTree.add("cm");
+    wordTree.add("ca");
+    wordTree.add("cq");
+    wordTree.add("cb");
+    wordTree.add("cma");
+    wordTree.add("c");
+    wordTree.add("cmz");
+
+    const auto predictions = wordTree.predict("c", 10);
+
+    ASSERT_EQ(7, predictions.size());
+    EXPECT_EQ("ca", predictions[0]);
+    EXPECT_EQ("cb", predictions[1]);
+    EXPECT_EQ("cm", predictions[2]);
+    EXPECT_EQ("cq", predictions[3]);
+    EXPECT_EQ("cz", predictions[4]);
+    EXPECT_EQ("cma", predictions[5]);
+    EXPECT_EQ("cmz", predictions[6]);
+
+    EXPECT_EQ(8, wordTree.size());
+    EXPECT_TRUE(wordTree.find("cmz"));
+    EXPECT_FALSE(wordTree.find("cqa"));
+}
+
+TEST(WordGraph_Freeze, MatchesTree)
+{
+    WordTree wordTree;
+
+    wordTree.add("apple");
+    wordTree.add("apply");
+    wordTree.add("exam");
+    wordTree.add("exit");
+    wordTree.add("exist");
+    wordTree.add("exits");
+    wordTree.add("extra");
+    wordTree.add("excite");
+    wordTree.add("exciting");
+    wordTree.add("walking");
+    wordTree.add("talking");
+    wordTree.add("stalking");
+    wordTree.add("walk");
+    wordTree.add("talk");
+
+    const WordGraph wordGraph(wordTree);
+
+    EXPECT_EQ(wordTree.size(), wordGraph.size());
+    for (auto word : { "apple", "apply", "exits", "excite", "walking", "stalking", "talk" })
+    {
+        EXPECT_TRUE(wordGraph.find(word));
+    }
+    for (auto word : { "", "app", "stalk", "alking", "walks", "WALK!" })
+    {
+        EXPECT_FALSE(wordGraph.find(word));
+    }
+    EXPECT_TRUE(wordGraph.find("TaLk"));
+
+    for (auto partial : { "a", "ex", "exi", "wal", "t", "s", "Ex", "", "q", "ex!" })
+    {
+        for (std::uint8_t howMany : { 1, 3, 20 })
+        {
+            EXPECT_EQ(wordTree.predict(partial, howMany), wordGraph.predict(partial, howMany));
+        }
+    }
+}
+
+TEST(WordGraph_Freeze, SharesSuffixes)
+{
+    WordTree wordTree;
+
+    // Every word ends in "ing", so the graph keeps that ending only once
+    for (auto word : { "walking", "talking", "stalking", "baking", "making", "taking", "faking" })
+    {
+        wordTree.add(word);
+    }
+
+    const WordGraph wordGraph(wordTree);
+
+    EXPECT_EQ(7, wordGraph.size());
+    // The tree needs 45 nodes. The graph needs one for each distinct set of endings: the root,
+    // "alking", "alking" or "aking", "talking", "aking", "lking" or "king", "lking", "king",
+    // "ing", "ng", "g" and the end of a word.
+    EXPECT_EQ(12, wordGraph.getNodeCount());
+    EXPECT_EQ(wordTree.predict("ta", 5), wordGraph.predict("ta", 5));
+}
+
+TEST(WordGraph_Freeze, HasOneNodePerMinimalState)
+{
+    WordTree wordTree;
+
+    for (auto word : { "tap", "taps", "top", "tops", "stop", "stops" })
+    {
+        wordTree.add(word);
+    }
+
+    const WordGraph wordGraph(wordTree);
+
+    // The "p" of "tap", "top" and "stop" is one node, even though the "o" of "stop" has no
+    // sibling and the "a" and "o" of "tap" and "top" do. The minimal automaton has 7 states:
+    // the root, "ap(s)" or "op(s)", "top(s)", "op(s)", "p(s)", "s" or the end, and the end.
+    EXPECT_EQ(7, wordGraph.getNodeCount());
+    for (auto word : { "tap", "taps", "top", "tops", "stop", "stops" })
+    {
+        EXPECT_TRUE(wordGraph.find(word));
+    }
+    for (auto word : { "stap", "staps", "to", "sto", "topss" })
+    {
+        EXPECT_FALSE(wordGraph.find(word));
+    }
+    EXPECT_EQ(wordTree.predict("t", 5), wordGraph.predict("t", 5));
+    EXPECT_EQ(wordTree.predict("s", 5), wordGraph.predict("s", 5));
+}
+
+TEST(WordGraph_Freeze, KeepsScores)
+{
+    WordTree wordTree;
+
+    wordTree.add("the", 500);
+    wordTree.add("then", 40);
+    wordTree.add("there", 90);
+    wordTree.add("theory", 90);
+    wordTree.add("them", 120);
+    wordTree.add("walking", 3);
+    wordTree.add("talking", 3);
+    wordTree.add("stalking", 8);
+    wordTree.add("baking");
+
+    const WordGraph wordGraph(wordTree);
+
+    for (auto partial : { "t", "th", "the", "s", "b", "q" })
+    {
+        for (std::uint8_t howMany : { 1, 3, 20 })
+        {
+            EXPECT_EQ(wordTree.predict(partial, howMany), wordGraph.predict(partial, howMany));
+        }
+    }
+    EXPECT_EQ(std::vector<std::string>({ "the", "them", "there" }), wordGraph.predict("t", 3));
+    EXPECT_EQ(std::vector<std::string>({ "talking" }), wordGraph.predict("ta", 3));
+}
+
+TEST(WordGraph_Freeze, ScoresDoNotStopSharing)
+{
+    WordTree scored;
+    WordTree unscored;
+
+    std::uint32_t score = 1;
+    for (auto word : { "walking", "talking", "stalking", "baking", "making", "taking", "faking" })
+    {
+        scored.add(word, score *= 3);
+        unscored.add(word);
+    }
+
+    const WordGraph scoredGraph(scored);
+    const WordGraph unscoredGraph(unscored);
+
+    // Every word has its own score, yet the endings are shared just as without scores
+    EXPECT_EQ(unscoredGraph.getNodeCount(), scoredGraph.getNodeCount());
+    for (auto partial : { "t", "ta", "s", "b", "w", "f" })
+    {
+        for (std::uint8_t howMany : { 1, 2, 5 })
+        {
+            EXPECT_EQ(scored.predict(partial, howMany), scoredGraph.predict(partial, howMany));
+        }
+    }
+    EXPECT_EQ(std::vector<std::string>({ "taking", "talking" }), scoredGraph.predict("t", 2));
+}
+
+TEST(WordGraph_Freeze, EmptyTree)
+{
+    WordTree wordTree;
+    const WordGraph wordGraph(wordTree);
+
+    EXPECT_EQ(0, wordGraph.size());
+    EXPECT_FALSE(wordGraph.find("a"));
+    EXPECT_EQ(0, wordGraph.predict("a", 5).size());
+}
+
+TEST(WordGraph_Save, MappedGraphMatchesBuiltOne)
+{
+    WordTree wordTree;
+
+    for (auto word : { "apple", "apply", "exam", "exit", "exist", "exits", "walking", "talking", "talk" })
+    {
+        wordTree.add(word);
+    }
+    const WordGraph built(wordTree);
+    std::string path = (std::filesystem::temp_directory_path() / "TestWordTree_graph.dawg").string();
+    built.save(path);
+
+    {
+        const WordGraph mapped(path);
+
+        EXPECT_TRUE(mapped.isMapped());
+        EXPECT_FALSE(built.isMapped());
+        EXPECT_EQ(built.size(), mapped.size());
+        EXPECT_EQ(built.getNodeCount(), mapped.getNodeCount());
+        EXPECT_TRUE(mapped.find("talking"));
+        EXPECT_FALSE(mapped.find("talki"));
+        for (auto partial : { "a", "ex", "t", "z" })
+        {
+            EXPECT_EQ(built.predict(partial, 10), mapped.predict(partial, 10));
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(WordGraph_Save, MappedGraphKeepsScores)
+{
+    WordTree wordTree;
+
+    wordTree.add("exam", 2);
+    wordTree.add("exit", 50);
+    wordTree.add("exist", 9);
+    wordTree.add("extra");
+    wordTree.add("excite", 50);
+    std::string path = (std::filesystem::temp_directory_path() / "TestWordTree_scored.dawg").string();
+    WordGraph(wordTree).save(path);
+
+    {
+        const WordGraph mapped(path);
+
+        EXPECT_EQ(std::vector<std::string>({ "exit", "excite", "exist", "exam", "extra" }), mapped.predict("ex", 10));
+        EXPECT_EQ(wordTree.predict("exi", 10), mapped.predict("exi", 10));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(WordGraph_Save, RejectsDamagedFiles)
+{
+    WordTree wordTree;
+    wordTree.add("abc");
+    wordTree.add("abd");
+    std::string path = (std::filesystem::temp_directory_path() / "TestWordTree_damaged.dawg").string();
+
+    EXPECT_THROW(WordGraph(std::string("TestWordTree_missing.dawg")), std::runtime_error);
+
+    WordGraph(wordTree).save(path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+    EXPECT_THROW(WordGraph{ path }, std::runtime_error);
+
+    // The graph has 4 nodes: the root, "a", "b" and the end of both words. Edge 2 is the "c"
+    // of node 2, the "b"; pointing it back at that node would send queries round in circles.
+    WordGraph(wordTree).save(path);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::uint32_t target = 2;
+        file.seekp(sizeof(WordGraphHeader) + 4 * 12 + 2 * 4);
+        file.write(reinterpret_cast<const char*>(&target), sizeof(target));
+    }
+    EXPECT_THROW(WordGraph{ path }, std::runtime_error);
+
+    // Node 1 claiming its edges start after the ones of node 2
+    WordGraph(wordTree).save(path);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::uint32_t firstEdge = 2;
+        file.seekp(sizeof(WordGraphHeader) + 1 * 12 + 4);
+        file.write(reinterpret_cast<const char*>(&firstEdge), sizeof(firstEdge));
+    }
+    EXPECT_THROW(WordGraph{ path }, std::runtime_error);
+
+    // Node 2 claiming more words than its edges lead to would number words past the scores
+    WordGraph(wordTree).save(path);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::uint32_t wordCount = 5;
+        file.seekp(sizeof(WordGraphHeader) + 2 * 12 + 8);
+        file.write(reinterpret_cast<const char*>(&wordCount), sizeof(wordCount));
+    }
+    EXPECT_THROW(WordGraph{ path }, std::runtime_error);
+
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "not a graph at all, just some text";
+    }
+    EXPECT_THROW(WordGraph{ path }, std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(WordTree_Predict, HighestScoresComeFirst)
+{
+    WordTree wordTree;
+
+    wordTree.add("the", 500);
+    wordTree.add("then", 40);
+    wordTree.add("there", 90);
+    wordTree.add("therefore", 90);
+    wordTree.add("thesaurus", 2);
+    wordTree.add("theory", 90);
+    wordTree.add("thee");
+    wordTree.add("theme", 7);
+    wordTree.add("them", 120);
+
+    const auto predictions = wordTree.predict("th", 6);
+
+    ASSERT_EQ(6, predictions.size());
+    EXPECT_EQ("the", predictions[0]);
+    EXPECT_EQ("them", predictions[1]);
+    // Equal scores: shorter words first, then alphabetical
+    EXPECT_EQ("there", predictions[2]);
+    EXPECT_EQ("theory", predictions[3]);
+    EXPECT_EQ("therefore", predictions[4]);
+    EXPECT_EQ("then", predictions[5]);
+
+    const auto all = wordTree.predict("the", 20);
+
+    ASSERT_EQ(8, all.size());
+    EXPECT_EQ("theme", all[5]);
+    EXPECT_EQ("thesaurus", all[6]);
+    EXPECT_EQ("thee", all[7]);
+}
+
+TEST(WordTree_Predict, ReaddingKeepsHigherScore)
+{
+    WordTree wordTree;
+
+    wordTree.add("cat", 5);
+    wordTree.add("car", 10);
+    wordTree.add("cat", 20);
+    wordTree.add("cat", 1);
+    wordTree.add("cab9", 100);
+
+    const auto predictions = wordTree.predict("ca", 3);
+
+    EXPECT_EQ(2, wordTree.size());
+    ASSERT_EQ(2, predictions.size());
+    EXPECT_EQ("cat", predictions[0]);
+    EXPECT_EQ("car", predictions[1]);
+}
+
+TEST(WordTree_Predict, DeepWordWithHigherScoreBeatsShortOnes)
+{
+    WordTree wordTree;
+
+    for (char second = 'a'; second <= 'z'; second++)
+    {
+        for (char third = 'a'; third <= 'z'; third++)
+        {
+            wordTree.add(std::string("q") + second + third);
+        }
+    }
+    wordTree.add("quintessential", 3);
+    wordTree.add("quixotically", 1);
+
+    const auto predictions = wordTree.predict("q", 3);
+
+    ASSERT_EQ(3, predictions.size());
+    EXPECT_EQ("quintessential", predictions[0]);
+    EXPECT_EQ("quixotically", predictions[1]);
+    EXPECT_EQ("qaa", predictions[2]);
+}
+
+TEST(WordTree_Predict, EqualScoresGiveBreadthFirstOrder)
+{
+    WordTree unscored;
+    WordTree scored;
+
+    for (auto word : { "exam", "exit", "exist", "exits", "extra", "excite", "expect", "execute", "exciting", "explode", "ex" })
+    {
+        unscored.add(word);
+        scored.add(word, 7);
+    }
+
+    EXPECT_EQ(unscored.predict("e", 20), scored.predict("e", 20));
+    EXPECT_EQ(unscored.predict("ex", 4), scored.predict("ex", 4));
+}
+
+TEST(Dictionary_Read, CountsBecomeScores)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "TestWordTree_counts.txt").string();
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << "the\t500\r\nthen\t40\nThere\t90\nthem\t99999999999\nthey\tmany\ntheir\t\nthemselves\nth3m\t7\n";
+    }
+
+    auto wordTree = readDictionary(path);
+
+    // "they" and "their" have counts that are not numbers and "th3m" is not a word
+    EXPECT_EQ(5, wordTree->size());
+    EXPECT_FALSE(wordTree->find("they"));
+    EXPECT_EQ(std::vector<std::string>({ "them", "the", "there", "then", "themselves" }), wordTree->predict("th", 10));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,460 @@
+#include "WordGraph.hpp"
+
+#include "WordPrediction.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static_assert(sizeof(WordGraphHeader) == 32, "The graph header is read straight from the file");
+static_assert(std::endian::native == std::endian::little, "Graphs store words in little-endian order");
+
+namespace
+{
+    // Maps the whole file read-only; returns nullptr for an empty file
+    void* mapFile(const std::string& path, std::size_t& bytes)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Cannot open word graph " + path);
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot read the size of word graph " + path);
+        }
+        bytes = static_cast<std::size_t>(size.QuadPart);
+        if (bytes == 0)
+        {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            throw std::runtime_error("Cannot open word graph " + path);
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0)
+        {
+            close(file);
+            throw std::runtime_error("Cannot read the size of word graph " + path);
+        }
+        bytes = static_cast<std::size_t>(status.st_size);
+        if (bytes == 0)
+        {
+            close(file);
+            return nullptr;
+        }
+
+        void* view = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (view == MAP_FAILED)
+        {
+            view = nullptr;
+        }
+#endif
+        if (view == nullptr)
+        {
+            throw std::runtime_error("Cannot map word graph " + path);
+        }
+        return view;
+    }
+
+    // Walks a graph for predictWords: like NodeBlocks, but a node's children are found through its
+    // edges, and a position also carries the number of the first word below it, which is where
+    // its scores are found
+    template <typename Node>
+    class NodeEdges
+    {
+      public:
+        class Position
+        {
+          public:
+            std::uint32_t node;
+            std::uint32_t firstWord;
+        };
+        static constexpr std::uint32_t LETTER_BITS = (1u << 26) - 1;
+        static constexpr std::uint32_t END_OF_WORD = 1u << 26;
+
+        const Node* nodes;
+        const std::uint32_t* edges;
+        const std::uint32_t* scores;
+        std::uint32_t scoredWords;
+
+        bool isWord(Position position) const
+        {
+            return (nodes[position.node].letters & END_OF_WORD) != 0;
+        }
+        // A word comes before the longer words starting with it, so it has the first number below its node
+        std::uint32_t getScore(Position position) const
+        {
+            return scoredWords != 0 ? scores[scoredWords + position.firstWord] : 0;
+        }
+        std::uint32_t getBestScore(Position position) const
+        {
+            if (scoredWords == 0)
+            {
+                return 0;
+            }
+            std::uint32_t best = 0;
+            std::uint64_t begin = static_cast<std::uint64_t>(scoredWords) + position.firstWord;
+            std::uint64_t end = begin + nodes[position.node].wordCount;
+            for (; begin < end; begin >>= 1, end >>= 1)
+            {
+                if (begin & 1)
+                {
+                    best = std::max(best, scores[begin++]);
+                }
+                if (end & 1)
+                {
+                    best = std::max(best, scores[--end]);
+                }
+            }
+            return best;
+        }
+        template <typename Visit>
+        void forEachChild(Position position, Visit visit) const
+        {
+            const Node& node = nodes[position.node];
+            const std::uint32_t* edge = edges + node.firstEdge;
+            std::uint32_t firstWord = position.firstWord + ((node.letters & END_OF_WORD) ? 1 : 0);
+            for (std::uint32_t letters = node.letters & LETTER_BITS; letters != 0; letters &= letters - 1)
+            {
+                visit(static_cast<char>(std::countr_zero(letters) + 'a'), Position{ *edge, firstWord });
+                firstWord += nodes[*edge].wordCount;
+                edge++;
+            }
+        }
+    };
+
+    void unmapFile(void* view, std::size_t bytes)
+    {
+#if defined(_WIN32)
+        (void)bytes;
+        UnmapViewOfFile(view);
+#else
+        munmap(view, bytes);
+#endif
+    }
+}
+
+WordGraph::WordGraph(const WordTree& tree)
+{
+    // States are registered from the leaves up. Once its children have been registered, a node
+    // accepts the same words as an earlier state exactly when its letters and the states its
+    // letters lead to are equal, so each key is only stored once and the result is the minimal
+    // automaton. Scores are collected separately, in the order the words are numbered.
+    auto hashKey = [](const std::vector<std::uint32_t>& key)
+    {
+        std::uint64_t hash = key.size();
+        for (std::uint32_t value : key)
+        {
+            hash = hash * 0x100000001b3ull ^ value;
+        }
+        return static_cast<std::size_t>(hash);
+    };
+    std::unordered_map<std::vector<std::uint32_t>, std::uint32_t, decltype(hashKey)> states(0, hashKey);
+    std::vector<Node> registered;
+    std::vector<std::uint32_t> targets;
+    std::vector<std::uint32_t> wordScores;
+
+    std::function<std::uint32_t(std::uint32_t)> merge = [&](std::uint32_t treeNode)
+    {
+        const WordTree::TreeNode& original = tree.nodes[treeNode];
+        std::uint32_t wordCount = (original.letters & END_OF_WORD) ? 1 : 0;
+        if (wordCount != 0)
+        {
+            wordScores.push_back(original.score);
+        }
+
+        std::vector<std::uint32_t> key = { original.letters };
+        for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(std::popcount(original.letters & LETTER_BITS)); i++)
+        {
+            key.push_back(merge(original.firstChild + i));
+            wordCount += registered[key.back()].wordCount;
+        }
+
+        auto [state, added] = states.try_emplace(key, static_cast<std::uint32_t>(registered.size()));
+        if (added)
+        {
+            Node node;
+            node.letters = original.letters;
+            node.firstEdge = static_cast<std::uint32_t>(targets.size());
+            node.wordCount = wordCount;
+            registered.push_back(node);
+            targets.insert(targets.end(), key.begin() + 1, key.end());
+        }
+        return state->second;
+    };
+    merge(WordTree::ROOT);
+
+    // Children are registered before their parents, so numbering the states backwards puts the
+    // root at 0 and makes every edge lead forwards
+    std::uint32_t last = static_cast<std::uint32_t>(registered.size()) - 1;
+    builtNodes.reserve(registered.size());
+    builtEdges.reserve(targets.size());
+    for (std::uint32_t i = 0; i <= last; i++)
+    {
+        Node node = registered[last - i];
+        std::uint32_t edge = node.firstEdge;
+        node.firstEdge = static_cast<std::uint32_t>(builtEdges.size());
+        for (std::uint32_t child = 0; child < static_cast<std::uint32_t>(std::popcount(node.letters & LETTER_BITS)); child++)
+        {
+            builtEdges.push_back(last - targets[edge + child]);
+        }
+        builtNodes.push_back(node);
+    }
+    nodes = builtNodes.data();
+    edges = builtEdges.data();
+    nodeCount = static_cast<std::uint32_t>(builtNodes.size());
+    edgeCount = static_cast<std::uint32_t>(builtEdges.size());
+    words = wordScores.size();
+
+    // The max tree keeps the scores as its leaves, with the higher score of nodes 2i and 2i + 1 at i
+    if (std::any_of(wordScores.begin(), wordScores.end(), [](std::uint32_t score) { return score != 0; }))
+    {
+        scoredWords = words;
+        builtScores.resize(2 * wordScores.size());
+        std::copy(wordScores.begin(), wordScores.end(), builtScores.begin() + wordScores.size());
+        for (std::size_t i = wordScores.size() - 1; i > 0; i--)
+        {
+            builtScores[i] = std::max(builtScores[2 * i], builtScores[2 * i + 1]);
+        }
+        scores = builtScores.data();
+    }
+}
+
+WordGraph::WordGraph(const std::string& path)
+{
+    mapping = mapFile(path, mappingBytes);
+
+    WordGraphHeader header;
+    if (mappingBytes < sizeof(WordGraphHeader))
+    {
+        unmap();
+        throw std::runtime_error("Word graph " + path + " is too short");
+    }
+    std::memcpy(&header, mapping, sizeof(WordGraphHeader));
+
+    if (std::memcmp(header.magic, WordGraphHeader::MAGIC, sizeof(header.magic)) != 0 || header.version != WordGraphHeader::VERSION)
+    {
+        unmap();
+        throw std::runtime_error(path + " is not a version " + std::to_string(WordGraphHeader::VERSION) + " word graph");
+    }
+    std::size_t nodeBytes = static_cast<std::size_t>(header.nodeCount) * sizeof(Node);
+    if (header.nodeCount == 0 || mappingBytes - sizeof(WordGraphHeader) < nodeBytes)
+    {
+        unmap();
+        throw std::runtime_error("Word graph " + path + " is truncated");
+    }
+
+    nodes = reinterpret_cast<const Node*>(static_cast<const char*>(mapping) + sizeof(WordGraphHeader));
+    edges = reinterpret_cast<const std::uint32_t*>(static_cast<const char*>(mapping) + sizeof(WordGraphHeader) + nodeBytes);
+    nodeCount = header.nodeCount;
+    words = header.words;
+    scoredWords = header.scoredWords;
+
+    // Each node's edges follow the ones of the node before it, and every edge leads forwards,
+    // which also rules out cycles; checking that keeps a damaged file from sending queries out
+    // of bounds or in circles
+    std::uint64_t edgesEnd = 0;
+    for (std::uint32_t i = 0; i < nodeCount; i++)
+    {
+        if ((nodes[i].letters & ~(LETTER_BITS | END_OF_WORD)) != 0 || nodes[i].firstEdge != edgesEnd)
+        {
+            unmap();
+            throw std::runtime_error("Word graph " + path + " is corrupt");
+        }
+        edgesEnd += std::popcount(nodes[i].letters & LETTER_BITS);
+    }
+    if ((scoredWords != 0 && scoredWords != words) || mappingBytes != sizeof(WordGraphHeader) + nodeBytes + (edgesEnd + 2 * scoredWords) * sizeof(std::uint32_t))
+    {
+        unmap();
+        throw std::runtime_error("Word graph " + path + " is truncated");
+    }
+    edgeCount = static_cast<std::uint32_t>(edgesEnd);
+    scores = edges + edgeCount;
+
+    // Word numbers index the scores, so every node has to count exactly the words below it
+    for (std::uint32_t i = 0; i < nodeCount; i++)
+    {
+        std::uint64_t wordCount = (nodes[i].letters & END_OF_WORD) ? 1 : 0;
+        std::uint32_t edgeEnd = nodes[i].firstEdge + static_cast<std::uint32_t>(std::popcount(nodes[i].letters & LETTER_BITS));
+        for (std::uint32_t edge = nodes[i].firstEdge; edge < edgeEnd; edge++)
+        {
+            if (edges[edge] <= i || edges[edge] >= nodeCount)
+            {
+                unmap();
+                throw std::runtime_error("Word graph " + path + " is corrupt");
+            }
+            wordCount += nodes[edges[edge]].wordCount;
+        }
+        if (wordCount != nodes[i].wordCount || (i == ROOT && wordCount != words))
+        {
+            unmap();
+            throw std::runtime_error("Word graph " + path + " is corrupt");
+        }
+    }
+}
+
+WordGraph::~WordGraph()
+{
+    unmap();
+}
+
+void WordGraph::unmap()
+{
+    if (mapping != nullptr)
+    {
+        unmapFile(mapping, mappingBytes);
+        mapping = nullptr;
+    }
+}
+
+void WordGraph::save(const std::string& path) const
+{
+    WordGraphHeader header = {};
+    std::memcpy(header.magic, WordGraphHeader::MAGIC, sizeof(header.magic));
+    header.version = WordGraphHeader::VERSION;
+    header.nodeCount = nodeCount;
+    header.words = words;
+    header.scoredWords = scoredWords;
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        output.write(reinterpret_cast<const char*>(nodes), static_cast<std::streamsize>(nodeCount * sizeof(Node)));
+        output.write(reinterpret_cast<const char*>(edges), static_cast<std::streamsize>(edgeCount * sizeof(std::uint32_t)));
+        output.write(reinterpret_cast<const char*>(scores), static_cast<std::streamsize>(2 * scoredWords * sizeof(std::uint32_t)));
+        output.close();
+        if (!output)
+        {
+            std::filesystem::remove(temporaryPath);
+            throw std::runtime_error("Cannot write word graph " + temporaryPath);
+        }
+    }
+    std::filesystem::rename(temporaryPath, path);
+}
+
+bool WordGraph::isMapped() const
+{
+    return mapping != nullptr;
+}
+
+bool WordGraph::find(std::string word) const
+{
+    if (word.length() <= 0)
+    {
+        return false;
+    }
+
+    std::uint32_t firstWord = 0;
+    std::uint32_t current = findPrefix(word, firstWord);
+    return current != 0 && (nodes[current].letters & END_OF_WORD) != 0;
+}
+
+std::vector<std::string> WordGraph::predict(std::string partial, std::uint8_t howMany) const
+{
+    std::vector<std::string> predictions;
+    if (partial.length() <= 0)
+    {
+        return predictions;
+    }
+
+    std::uint32_t firstWord = 0;
+    std::uint32_t current = findPrefix(partial, firstWord);
+    if (current == 0)
+    {
+        return predictions;
+    }
+
+    NodeEdges<Node> graph = { nodes, edges, scores, static_cast<std::uint32_t>(scoredWords) };
+    return predictWords(graph, { current, firstWord }, partial, howMany);
+}
+
+std::size_t WordGraph::size() const
+{
+    return static_cast<std::size_t>(words);
+}
+
+std::size_t WordGraph::getNodeCount() const
+{
+    return nodeCount;
+}
+
+// Also moves `firstWord` past the words that come before the ones through the child
+std::uint32_t WordGraph::getChild(std::uint32_t node, int letter, std::uint32_t& firstWord) const
+{
+    std::uint32_t letters = nodes[node].letters;
+    if ((letters & (1u << letter)) == 0)
+    {
+        return 0;
+    }
+
+    const std::uint32_t* edge = edges + nodes[node].firstEdge;
+    const std::uint32_t* child = edge + std::popcount(letters & ((1u << letter) - 1));
+    firstWord += (letters & END_OF_WORD) ? 1 : 0;
+    for (; edge != child; edge++)
+    {
+        firstWord += nodes[*edge].wordCount;
+    }
+    return *child;
+}
+
+// The node reached by following the letters of `partial`, or 0 if there is none, and the number
+// of the first word starting with `partial`
+std::uint32_t WordGraph::findPrefix(const std::string& partial, std::uint32_t& firstWord) const
+{
+    std::uint32_t current = ROOT;
+    for (char character : partial)
+    {
+        char letter = static_cast<char>(std::tolower(character));
+        if (!std::isalpha(letter) || letter < 'a' || letter > 'z')
+        {
+            return 0;
+        }
+
+        current = getChild(current, letter - 'a', firstWord);
+        if (current == 0)
+        {
+            return 0;
+        }
+    }
+    return current;
+}
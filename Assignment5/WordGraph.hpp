@@ -0,0 +1,94 @@
+#pragma once
+
+#include "WordTree.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Layout of a saved graph: this header, then the nodes as three 32-bit words each: the letters,
+// the first edge and the number of words below, then the edges as one 32-bit node index each,
+// then the scores. A node's edges follow those of the node before it, so the edge count is not
+// stored. The scores are a max tree over the words in alphabetical order, 2 * words 32-bit words
+// with the score of word i at words + i, and are left out when no word has a score.
+// Nodes only refer to each other by index, so the file can be mapped anywhere and used in
+// place. Everything is little-endian.
+class WordGraphHeader
+{
+  public:
+    static constexpr char MAGIC[8] = { 'W', 'O', 'R', 'D', 'D', 'A', 'W', 'G' };
+    static constexpr std::uint32_t VERSION = 4;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t nodeCount;
+    std::uint64_t words;
+    // Either words or 0
+    std::uint64_t scoredWords;
+};
+
+// A read-only copy of a WordTree minimized into a directed acyclic word graph: every set of
+// endings is stored once, so "walking", "talking" and "stalking" share the nodes for "alking",
+// and the graph has one node per state of the minimal automaton. A node holds a bit per letter,
+// the index of its first edge and how many words it leads to; its edges hold the nodes the
+// letters lead to, in letter order.
+//
+// Scores stay out of the nodes, so words with different scores still share their endings.
+// Counting the words passed on the way to a word numbers it in alphabetical order, and its score
+// is looked up by that number. The words starting with a prefix have consecutive numbers, so the
+// best score below a node comes from a max tree over the scores, and predictions come in the
+// same order as from WordTree.
+class WordGraph
+{
+  public:
+    explicit WordGraph(const WordTree& tree);
+    // Maps a graph written by save() and queries it in place, so loading does not depend on the
+    // size of the dictionary and processes using the same file share its pages. Throws
+    // std::runtime_error when the file is missing, truncated or not a graph.
+    explicit WordGraph(const std::string& path);
+    ~WordGraph();
+    WordGraph(const WordGraph&) = delete;
+    WordGraph& operator=(const WordGraph&) = delete;
+
+    // Goes through a temporary file, so an existing graph is only replaced once the new one is complete
+    void save(const std::string& path) const;
+    bool isMapped() const;
+
+    bool find(std::string word) const;
+    std::vector<std::string> predict(std::string partial, std::uint8_t howMany) const;
+    std::size_t size() const;
+    // Nodes in the graph, counting the root
+    std::size_t getNodeCount() const;
+
+  private:
+    class Node
+    {
+      public:
+        std::uint32_t letters = 0;
+        std::uint32_t firstEdge = 0;
+        // Words ending here or below
+        std::uint32_t wordCount = 0;
+    };
+    static constexpr std::uint32_t LETTER_BITS = (1u << 26) - 1;
+    static constexpr std::uint32_t END_OF_WORD = 1u << 26;
+    static constexpr std::uint32_t ROOT = 0;
+    // Either builtNodes and builtEdges or the ones in the mapped file. Edges always lead to a
+    // node with a higher index, and the root is node 0, so 0 also marks a missing child.
+    const Node* nodes = nullptr;
+    const std::uint32_t* edges = nullptr;
+    std::uint32_t nodeCount = 0;
+    std::uint32_t edgeCount = 0;
+    std::uint64_t words = 0;
+    // Empty when no word has a score
+    const std::uint32_t* scores = nullptr;
+    std::uint64_t scoredWords = 0;
+    std::vector<Node> builtNodes;
+    std::vector<std::uint32_t> builtEdges;
+    std::vector<std::uint32_t> builtScores;
+    void* mapping = nullptr;
+    std::size_t mappingBytes = 0;
+
+    std::uint32_t getChild(std::uint32_t node, int letter, std::uint32_t& firstWord) const;
+    std::uint32_t findPrefix(const std::string& partial, std::uint32_t& firstWord) const;
+    void unmap();
+};
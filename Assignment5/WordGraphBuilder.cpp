@@ -0,0 +1,28 @@
+#include "Dictionary.hpp"
+#include "WordGraph.hpp"
+
+#include <exception>
+#include <iostream>
+
+// Freezes a word list into a graph file that TypeAhead maps at startup instead of rebuilding
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: WordGraphBuilder dictionary.txt dictionary.dawg\n";
+        return 1;
+    }
+
+    try
+    {
+        const WordGraph graph(*readDictionary(argv[1]));
+        graph.save(argv[2]);
+        std::cout << graph.size() << " words in " << graph.getNodeCount() << " nodes written to " << argv[2] << "\n";
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
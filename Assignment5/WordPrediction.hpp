@@ -0,0 +1,129 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// The prediction search shared by WordTree and WordGraph. `Nodes` walks the structure from a
+// Position: isWord() and getScore() describe the word ending there, getBestScore() gives the
+// highest score of any word below it, and forEachChild() calls back with each letter and the
+// position it leads to, in letter order. `start` is the position reached by `partial`.
+//
+// The highest scoring words come first; equal scores come shortest first, then in alphabetical
+// order, which is breadth-first order when no word has a score.
+template <typename Nodes>
+std::vector<std::string> predictWords(const Nodes& nodes, typename Nodes::Position start, const std::string& partial, std::uint8_t howMany)
+{
+    using Position = typename Nodes::Position;
+    std::vector<std::string> predictions;
+
+    // Without scores the order below is plain breadth-first order, which a queue gives far more cheaply
+    if (nodes.getBestScore(start) == 0)
+    {
+        std::queue<std::tuple<Position, std::string>> nodeQueue;
+        nodeQueue.push({ start, partial });
+
+        while (!nodeQueue.empty() && predictions.size() < howMany)
+        {
+            auto [position, word] = std::move(nodeQueue.front());
+            nodeQueue.pop();
+
+            if (nodes.isWord(position) && partial != word)
+            {
+                predictions.push_back(word);
+            }
+            nodes.forEachChild(position, [&](char letter, Position child)
+                               {
+                                   nodeQueue.push({ child, word + letter });
+                               });
+        }
+        return predictions;
+    }
+
+    // Best first: a subtree waits in the queue under the best score found in it, and a word under
+    // its own score, so words come out highest score first and a subtree is only opened once it
+    // might hold the next word. Equal scores are broken by length and then alphabetically.
+    class Candidate
+    {
+      public:
+        std::uint32_t score;
+        Position position;
+        bool isWord;
+        std::string word;
+    };
+    auto comesLater = [](const Candidate& a, const Candidate& b)
+    {
+        if (a.score != b.score)
+        {
+            return a.score < b.score;
+        }
+        if (a.word.length() != b.word.length())
+        {
+            return a.word.length() > b.word.length();
+        }
+        return a.word != b.word ? a.word > b.word : (!a.isWord && b.isWord);
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(comesLater)> candidates(comesLater);
+    candidates.push({ nodes.getBestScore(start), start, false, partial });
+
+    while (!candidates.empty() && predictions.size() < howMany)
+    {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+        if (candidate.isWord)
+        {
+            predictions.push_back(std::move(candidate.word));
+            continue;
+        }
+
+        if (nodes.isWord(candidate.position) && partial != candidate.word)
+        {
+            candidates.push({ nodes.getScore(candidate.position), candidate.position, true, candidate.word });
+        }
+        nodes.forEachChild(candidate.position, [&](char letter, Position child)
+                           {
+                               candidates.push({ nodes.getBestScore(child), child, false, candidate.word + letter });
+                           });
+    }
+    return predictions;
+}
+
+// Walks nodes that keep their children side by side in a block, as WordTree does: bits 0 to 25
+// of `letters` for the letters with a child and bit 26 for the end of a word, the index of the
+// first child, the score of the word ending at the node and the highest score below it.
+template <typename Node>
+class NodeBlocks
+{
+  public:
+    using Position = std::uint32_t;
+    static constexpr std::uint32_t LETTER_BITS = (1u << 26) - 1;
+    static constexpr std::uint32_t END_OF_WORD = 1u << 26;
+
+    const Node* nodes;
+
+    bool isWord(Position node) const
+    {
+        return (nodes[node].letters & END_OF_WORD) != 0;
+    }
+    std::uint32_t getScore(Position node) const
+    {
+        return nodes[node].score;
+    }
+    std::uint32_t getBestScore(Position node) const
+    {
+        return nodes[node].bestScore;
+    }
+    template <typename Visit>
+    void forEachChild(Position node, Visit visit) const
+    {
+        std::uint32_t child = nodes[node].firstChild;
+        for (std::uint32_t letters = nodes[node].letters & LETTER_BITS; letters != 0; letters &= letters - 1)
+        {
+            visit(static_cast<char>(std::countr_zero(letters) + 'a'), child++);
+        }
+    }
+};
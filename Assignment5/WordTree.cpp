@@ -1,57 +1,46 @@
 #include "WordTree.hpp"
 
+#include "WordPrediction.hpp"
+
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cctype>
 #include <iostream>
-#include <memory>
-#include <queue>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
-class TreeNode
-{
-    bool endOfWord;
-    std::array<std::shared_ptr<TreeNode>, 26> children;
-};
-
-void WordTree::add(std::string word)
+void WordTree::add(std::string word, std::uint32_t score)
 {
-    std::shared_ptr<TreeNode> currentNode = root;
+    std::uint32_t currentNode = ROOT;
 
-    if (word.length() == 0)
+    // Checked before anything is added, so a rejected word cannot raise the best scores on its path
+    if (word.length() == 0 || !std::all_of(word.begin(), word.end(), [](unsigned char c) { return std::isalpha(c); }))
     {
         return;
     }
 
+    nodes[ROOT].bestScore = std::max(nodes[ROOT].bestScore, score);
     for (int i = 0; i < static_cast<int>(word.length()); i++)
     {
-        char character = word[i];
-
-        if (!std::isalpha(character))
-        {
-            return;
-        }
-        if (std::isspace(character))
-        {
-            continue;
-        }
-
-        character = static_cast<char>(std::tolower(character));
+        char character = static_cast<char>(std::tolower(word[i]));
 
         int characterIndex = character - 'a';
 
-        if (currentNode->children[characterIndex] == nullptr)
-        {
-            currentNode->children[characterIndex] = std::make_shared<TreeNode>();
-        }
-        currentNode = currentNode->children[characterIndex];
+        std::uint32_t child = getChild(currentNode, characterIndex);
+        currentNode = (child != 0) ? child : addChild(currentNode, characterIndex);
+        nodes[currentNode].bestScore = std::max(nodes[currentNode].bestScore, score);
     }
-    currentNode->endOfWord = true;
+    nodes[currentNode].score = ((nodes[currentNode].letters & END_OF_WORD) != 0) ? std::max(nodes[currentNode].score, score) : score;
+    nodes[currentNode].letters |= END_OF_WORD;
 }
 
 bool WordTree::find(std::string word)
 {
-    std::shared_ptr<TreeNode> current = root;
+    std::uint32_t current = ROOT;
     int totalNumberOfLetters = 26;
 
     if (word.length() <= 0)
@@ -69,19 +58,23 @@ bool WordTree::find(std::string word)
 
         int characterIndex = letter - 'a';
 
-        if (characterIndex < 0 || characterIndex >= totalNumberOfLetters || !current->children[characterIndex])
+        if (characterIndex < 0 || characterIndex >= totalNumberOfLetters)
         {
             return false;
         }
 
-        current = current->children[characterIndex];
+        current = getChild(current, characterIndex);
+        if (current == 0)
+        {
+            return false;
+        }
     }
-    return current->endOfWord;
+    return (nodes[current].letters & END_OF_WORD) != 0;
 }
 
 std::vector<std::string> WordTree::predict(std::string partial, std::uint8_t howMany)
 {
-    std::shared_ptr<TreeNode> current = root;
+    std::uint32_t current = ROOT;
     std::vector<std::string> predictions;
 
     if (partial.length() <= 0)
@@ -100,59 +93,84 @@ std::vector<std::string> WordTree::predict(std::string partial, std::uint8_t how
 
         int characterIndex = letter - 'a';
 
-        if (current->children[characterIndex] == nullptr)
+        current = getChild(current, characterIndex);
+        if (current == 0)
         {
             return predictions;
         }
-        current = current->children[characterIndex];
     }
 
-    std::shared_ptr<TreeNode> traceBack = current;
-    std::queue<std::tuple<std::shared_ptr<TreeNode>, std::string>> treeNodeQueue;
-    treeNodeQueue.push({ current, partial });
-
-    while (!treeNodeQueue.empty() && predictions.size() < howMany)
-    {
-        auto [treeNode, word] = treeNodeQueue.front();
-        treeNodeQueue.pop();
-
-        if (treeNode->endOfWord && partial != word)
-        {
-            predictions.push_back(word);
-        }
-
-        for (int j = 0; j < static_cast<int>(treeNode->children.size()); j++)
-        {
-            if (treeNode->children[j])
-            {
-                char currentLetter = static_cast<char>(j + 'a');
-                treeNodeQueue.push({ std::tuple<std::shared_ptr<TreeNode>, std::string>(treeNode->children[j], word + currentLetter) });
-            }
-        }
-    }
-    return predictions;
+    return predictWords(NodeBlocks<TreeNode>{ nodes.data() }, current, partial, howMany);
 }
 
 std::size_t WordTree::size()
 {
     std::size_t totalWordsInTree = 0;
-    countWords(root, totalWordsInTree);
+    countWords(ROOT, totalWordsInTree);
 
     return totalWordsInTree;
 }
 
-void WordTree::countWords(std::shared_ptr<TreeNode>& child, std::size_t& count)
+void WordTree::countWords(std::uint32_t child, std::size_t& count)
 {
-    std::size_t totalLetters = 26;
-    if (child->endOfWord)
+    const TreeNode& node = nodes[child];
+    if (node.letters & END_OF_WORD)
     {
         count++;
     }
-    for (size_t i = 0; i < totalLetters; i++)
+    std::uint32_t children = static_cast<std::uint32_t>(std::popcount(node.letters & LETTER_BITS));
+    for (std::uint32_t i = 0; i < children; i++)
     {
-        if (child->children[i])
-        {
-            countWords(child->children[i], count);
-        }
+        countWords(node.firstChild + i, count);
+    }
+}
+
+std::uint32_t WordTree::getChild(std::uint32_t node, int letter) const
+{
+    std::uint32_t letters = nodes[node].letters;
+    if ((letters & (1u << letter)) == 0)
+    {
+        return 0;
+    }
+    return nodes[node].firstChild + static_cast<std::uint32_t>(std::popcount(letters & ((1u << letter) - 1)));
+}
+
+std::uint32_t WordTree::addChild(std::uint32_t node, int letter)
+{
+    // The node moves to a block one larger, with the new child slotted in at its letter
+    std::uint32_t count = static_cast<std::uint32_t>(std::popcount(nodes[node].letters & LETTER_BITS));
+    std::uint32_t position = static_cast<std::uint32_t>(std::popcount(nodes[node].letters & ((1u << letter) - 1)));
+    std::uint32_t block = allocateBlock(count + 1);
+    std::uint32_t oldBlock = nodes[node].firstChild;
+
+    std::copy(nodes.begin() + oldBlock, nodes.begin() + oldBlock + position, nodes.begin() + block);
+    nodes[block + position] = TreeNode();
+    std::copy(nodes.begin() + oldBlock + position, nodes.begin() + oldBlock + count, nodes.begin() + block + position + 1);
+    if (count > 0)
+    {
+        freeBlocks[count].push_back(oldBlock);
     }
+
+    nodes[node].letters |= 1u << letter;
+    nodes[node].firstChild = block;
+    return block + position;
+}
+
+std::uint32_t WordTree::allocateBlock(std::uint32_t count)
+{
+    if (!freeBlocks[count].empty())
+    {
+        std::uint32_t block = freeBlocks[count].back();
+        freeBlocks[count].pop_back();
+        return block;
+    }
+    if (nodes.size() + count > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::length_error("WordTree is out of node indexes");
+    }
+
+    // Growing the arena moves every node, so only indexes are held across it
+    std::uint32_t block = static_cast<std::uint32_t>(nodes.size());
+    nodes.resize(nodes.size() + count);
+    return block;
 }
@@ -2,25 +2,47 @@
 
 #include <array>
 #include <cstdint>
-#include <memory>
 #include <string>
 #include <vector>
 
 class WordTree
 {
   public:
-    void add(std::string word);
+    // Adding a word again keeps the higher of its scores
+    void add(std::string word, std::uint32_t score = 0);
     bool find(std::string word);
+    // The highest scoring words that start with `partial`; words with equal scores come shortest
+    // first, then in alphabetical order, which is breadth-first order when no word has a score
     std::vector<std::string> predict(std::string partial, std::uint8_t howMany);
     std::size_t size();
 
   private:
+    friend class WordGraph;
+
+    // Nodes live in one arena and link to their children by index, so a tree is a single
+    // allocation that is freed in one go. The children of a node sit side by side in a block,
+    // in letter order, so a node only needs a bit per letter and the index of its first child:
+    // the child for letter c is at firstChild + popcount(letters & ((1 << c) - 1)).
     class TreeNode
     {
       public:
-        bool endOfWord;
-        std::array<std::shared_ptr<WordTree::TreeNode>, 26> children;
+        // Bits 0 to 25 for the letters with a child, END_OF_WORD for the end of a word
+        std::uint32_t letters = 0;
+        std::uint32_t firstChild = 0;
+        // The score of the word ending here, and the highest score of any word in the subtree
+        std::uint32_t score = 0;
+        std::uint32_t bestScore = 0;
     };
-    std::shared_ptr<TreeNode> root = std::make_shared<TreeNode>();
-    void countWords(std::shared_ptr<TreeNode>& child, std::size_t& count);
+    static constexpr std::uint32_t LETTER_BITS = (1u << 26) - 1;
+    static constexpr std::uint32_t END_OF_WORD = 1u << 26;
+    // The root is node 0 and never in a block, so 0 also marks a missing child
+    static constexpr std::uint32_t ROOT = 0;
+    std::vector<TreeNode> nodes = std::vector<TreeNode>(1);
+    // Blocks left behind when a node outgrew them, by their number of nodes
+    std::array<std::vector<std::uint32_t>, 27> freeBlocks;
+
+    std::uint32_t getChild(std::uint32_t node, int letter) const;
+    std::uint32_t addChild(std::uint32_t node, int letter);
+    std::uint32_t allocateBlock(std::uint32_t count);
+    void countWords(std::uint32_t child, std::size_t& count);
 };
@@ -1,7 +1,10 @@
+#include "Dictionary.hpp"
+#include "WordGraph.hpp"
 #include "WordTree.hpp"
 #include "rlutil.h"
 
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <iterator>
@@ -9,18 +12,18 @@
 #include <sstream>
 #include <string>
 
-std::shared_ptr<WordTree> readDictionary(std::string filename);
+std::unique_ptr<WordGraph> loadDictionary();
 void drawToScreen(const std::string& input, int yOffset, int xOffset);
 std::string getLastWord(const std::string& input);
 
 int main()
 {
-    std::shared_ptr<WordTree> wordTree = readDictionary("dictionary.txt");
+    std::unique_ptr<WordGraph> dictionary = loadDictionary();
 
     bool finished = false;
 
     std::string word;
-    std::cout << wordTree->size();
+    std::cout << dictionary->size();
     rlutil::cls();
 
     std::string sentence;
@@ -52,7 +55,7 @@ int main()
 
         std::string lastWord = getLastWord(sentence);
 
-        std::vector<std::string> predictions = wordTree->predict(lastWord, static_cast<std::uint8_t>(rlutil::trows() - 5));
+        std::vector<std::string> predictions = dictionary->predict(lastWord, static_cast<std::uint8_t>(rlutil::trows() - 5));
 
         for (auto i = 0; i < static_cast<int>(predictions.size()); i++)
         {
@@ -89,34 +92,20 @@ std::string getLastWord(const std::string& input)
     return subs;
 }
 
-std::shared_ptr<WordTree> readDictionary(std::string filename)
+std::unique_ptr<WordGraph> loadDictionary()
 {
-    auto wordTree = std::make_shared<WordTree>();
-    std::ifstream inFile = std::ifstream(filename, std::ios::in);
-
-    while (!inFile.eof())
+    // A graph from WordGraphBuilder is mapped and used as it is; without one the word list is
+    // read and frozen, which takes much longer
+    if (std::filesystem::exists("dictionary.dawg"))
     {
-        std::string word;
-        std::getline(inFile, word);
-        // Need to consume the carriage return character for some systems, if it exists
-        if (!word.empty() && word[word.size() - 1] == '\r')
+        try
         {
-            word.erase(word.end() - 1);
+            return std::make_unique<WordGraph>(std::string("dictionary.dawg"));
         }
-        // Keep only if everything is an alphabetic character -- Have to send isalpha an unsigned char or
-        // it will throw exception on negative values; e.g., characters with accent marks.
-        if (std::all_of(word.begin(), word.end(), [](unsigned char c)
-                        {
-                            return std::isalpha(c);
-                        }))
+        catch (const std::runtime_error& error)
         {
-            std::transform(word.begin(), word.end(), word.begin(), [](char c)
-                           {
-                               return static_cast<char>(std::tolower(c));
-                           });
-            wordTree->add(word);
+            std::cerr << error.what() << std::endl;
         }
     }
-
-    return wordTree;
-}
\ No newline at end of file
+    return std::make_unique<WordGraph>(*readDictionary("dictionary.txt"));
+}
@@ -0,0 +1,356 @@
+#include "LifeKernel.hpp"
+#include "LifeRule.hpp"
+#include "LifeSimulator.hpp"
+#include "PatternAcorn.hpp"
+#include "PatternBitmap.hpp"
+#include "PatternGosperGliderGun.hpp"
+#include "PatternPacked.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    class Options
+    {
+      public:
+        std::string format = "csv";
+        std::vector<std::uint32_t> sizes = { 256, 1024, 4096 };
+        std::vector<double> densities = { 0.1, 0.35, 0.5 };
+        std::size_t generations = 100;
+        std::size_t warmup = 10;
+        std::size_t repetitions = 5;
+        std::size_t threads = 1;
+        bool allKernels = false;
+        LifeRule rule;
+    };
+
+    // One row of the results: a seed pattern on a square board, stepped by one kernel
+    class Scenario
+    {
+      public:
+        std::string pattern;
+        double density;
+        std::uint32_t size;
+        LifeKernelType kernel;
+    };
+
+    class Result
+    {
+      public:
+        Scenario scenario;
+        double medianGenerationsPerSecond;
+        double meanGenerationsPerSecond;
+        double deviationGenerationsPerSecond;
+        double medianCellUpdatesPerSecond;
+    };
+
+    const char* USAGE =
+        "Usage: LifeBenchmark [options]\n"
+        "  --format csv|json      output format, csv by default\n"
+        "  --sizes 256,1024,4096  board edge lengths\n"
+        "  --densities 0.1,0.35   live fractions of the random soups, from 0 to 1\n"
+        "  --generations N        generations timed per repetition, 100 by default\n"
+        "  --warmup N             generations run before timing, 10 by default\n"
+        "  --repetitions N        timed runs per scenario, 5 by default\n"
+        "  --threads N            worker threads, 1 by default\n"
+        "  --rule B3/S23          rule to simulate\n"
+        "  --all-kernels          time every supported kernel, not just the fastest\n";
+
+    template <typename T>
+    std::vector<T> parseList(const std::string& text)
+    {
+        std::vector<T> values;
+        std::istringstream input(text);
+        std::string item;
+        while (std::getline(input, item, ','))
+        {
+            std::istringstream itemInput(item);
+            T value;
+            if (!(itemInput >> value) || !itemInput.eof())
+            {
+                throw std::invalid_argument("Cannot read '" + item + "' in list " + text);
+            }
+            values.push_back(value);
+        }
+        return values;
+    }
+
+    std::size_t parseCount(const std::string& text)
+    {
+        auto values = parseList<std::size_t>(text);
+        if (values.size() != 1)
+        {
+            throw std::invalid_argument("Expected one number but got " + text);
+        }
+        return values[0];
+    }
+
+    Options parseOptions(int argc, char* argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string option = argv[i];
+            if (option == "--all-kernels")
+            {
+                options.allKernels = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+
+            std::string value = argv[++i];
+            if (option == "--format")
+            {
+                if (value != "csv" && value != "json")
+                {
+                    throw std::invalid_argument("Unsupported format " + value);
+                }
+                options.format = value;
+            }
+            else if (option == "--sizes")
+            {
+                options.sizes = parseList<std::uint32_t>(value);
+            }
+            else if (option == "--densities")
+            {
+                options.densities = parseList<double>(value);
+                for (double density : options.densities)
+                {
+                    if (!(density >= 0 && density <= 1))
+                    {
+                        throw std::invalid_argument("Soup densities have to be between 0 and 1 in " + value);
+                    }
+                }
+            }
+            else if (option == "--generations")
+            {
+                options.generations = parseCount(value);
+            }
+            else if (option == "--warmup")
+            {
+                options.warmup = parseCount(value);
+            }
+            else if (option == "--repetitions")
+            {
+                options.repetitions = std::max<std::size_t>(1, parseCount(value));
+            }
+            else if (option == "--threads")
+            {
+                options.threads = std::max<std::size_t>(1, parseCount(value));
+            }
+            else if (option == "--rule")
+            {
+                options.rule = LifeRule(value);
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option " + option + " " + value);
+            }
+        }
+        return options;
+    }
+
+    const char* getKernelName(LifeKernelType kernel)
+    {
+        switch (kernel)
+        {
+            case LifeKernelType::Sse2:
+                return "sse2";
+            case LifeKernelType::Avx2:
+                return "avx2";
+            default:
+                return "scalar";
+        }
+    }
+
+    // Fixed seed, so every run and every kernel starts from the same soup
+    PatternBitmap makeSoup(std::uint32_t size, double density)
+    {
+        std::mt19937 engine(12345);
+        std::bernoulli_distribution alive(density);
+        PatternBitmap soup(size, size);
+
+        for (std::uint32_t y = 0; y < size; y++)
+        {
+            for (std::uint32_t x = 0; x < size; x++)
+            {
+                soup.setCell(x, y, alive(engine));
+            }
+        }
+        return soup;
+    }
+
+    // Rates from one timed run. Cell updates only count the cells in tiles the simulator actually
+    // recomputed, so a sparse pattern on a large board is not credited for the empty space.
+    class Sample
+    {
+      public:
+        double generationsPerSecond;
+        double cellUpdatesPerSecond;
+    };
+
+    double median(std::vector<double> samples)
+    {
+        std::sort(samples.begin(), samples.end());
+        std::size_t middle = samples.size() / 2;
+        return (samples.size() % 2 == 1) ? samples[middle] : (samples[middle - 1] + samples[middle]) / 2;
+    }
+
+    Sample timeRepetition(const Scenario& scenario, const Options& options, const PatternPacked& seed)
+    {
+        LifeSimulator simulation(scenario.size, scenario.size, options.rule);
+        simulation.setKernel(scenario.kernel);
+        simulation.setThreadCount(options.threads);
+
+        // Small seeds start in the middle so they have room to grow
+        std::uint32_t startX = (scenario.size - std::min(seed.getSizeX(), scenario.size)) / 2;
+        std::uint32_t startY = (scenario.size - std::min(seed.getSizeY(), scenario.size)) / 2;
+        simulation.insertPattern(seed, startX, startY);
+        simulation.step(options.warmup);
+
+        // Generations run one at a time so the cells each one recomputed can be added up
+        std::uint64_t cellUpdates = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t generation = 0; generation < options.generations; generation++)
+        {
+            simulation.update();
+            cellUpdates += simulation.getActiveCellCount();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double seconds = std::max(elapsed.count(), 1e-9);
+        return { static_cast<double>(options.generations) / seconds, static_cast<double>(cellUpdates) / seconds };
+    }
+
+    Result runScenario(const Scenario& scenario, const Options& options, const PatternPacked& seed)
+    {
+        std::vector<double> samples;
+        std::vector<double> cellUpdates;
+        for (std::size_t repetition = 0; repetition < options.repetitions; repetition++)
+        {
+            Sample sample = timeRepetition(scenario, options, seed);
+            samples.push_back(sample.generationsPerSecond);
+            cellUpdates.push_back(sample.cellUpdatesPerSecond);
+        }
+
+        double mean = 0;
+        for (double sample : samples)
+        {
+            mean += sample / static_cast<double>(samples.size());
+        }
+        double variance = 0;
+        for (double sample : samples)
+        {
+            variance += (sample - mean) * (sample - mean);
+        }
+        variance = (samples.size() > 1) ? variance / static_cast<double>(samples.size() - 1) : 0;
+
+        return { scenario, median(samples), mean, std::sqrt(variance), median(cellUpdates) };
+    }
+
+    void printCsv(const std::vector<Result>& results, const Options& options)
+    {
+        std::cout << "pattern,density,size,kernel,threads,rule,generations,repetitions,"
+                  << "median_generations_per_second,mean_generations_per_second,stddev_generations_per_second,median_cell_updates_per_second\n";
+        for (const auto& result : results)
+        {
+            const Scenario& scenario = result.scenario;
+            std::cout << scenario.pattern << ',' << scenario.density << ',' << scenario.size << ','
+                      << getKernelName(scenario.kernel) << ',' << options.threads << ',' << options.rule.toString() << ','
+                      << options.generations << ',' << options.repetitions << ','
+                      << result.medianGenerationsPerSecond << ',' << result.meanGenerationsPerSecond << ','
+                      << result.deviationGenerationsPerSecond << ',' << result.medianCellUpdatesPerSecond << '\n';
+        }
+    }
+
+    void printJson(const std::vector<Result>& results, const Options& options)
+    {
+        std::cout << "[\n";
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const Result& result = results[i];
+            const Scenario& scenario = result.scenario;
+            std::cout << "  { \"pattern\": \"" << scenario.pattern << "\", \"density\": " << scenario.density
+                      << ", \"size\": " << scenario.size << ", \"kernel\": \"" << getKernelName(scenario.kernel)
+                      << "\", \"threads\": " << options.threads << ", \"rule\": \"" << options.rule.toString()
+                      << "\", \"generations\": " << options.generations << ", \"repetitions\": " << options.repetitions
+                      << ", \"medianGenerationsPerSecond\": " << result.medianGenerationsPerSecond
+                      << ", \"meanGenerationsPerSecond\": " << result.meanGenerationsPerSecond
+                      << ", \"stddevGenerationsPerSecond\": " << result.deviationGenerationsPerSecond
+                      << ", \"medianCellUpdatesPerSecond\": " << result.medianCellUpdatesPerSecond << " }"
+                      << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        std::cout << "]\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    try
+    {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cerr << error.what() << "\n"
+                  << USAGE;
+        return 1;
+    }
+
+    std::vector<LifeKernelType> kernels = { detectLifeKernel() };
+    if (options.allKernels)
+    {
+        kernels.clear();
+        for (auto kernel : { LifeKernelType::Scalar, LifeKernelType::Sse2, LifeKernelType::Avx2 })
+        {
+            if (isLifeKernelSupported(kernel))
+            {
+                kernels.push_back(kernel);
+            }
+        }
+    }
+
+    PatternAcorn acorn;
+    PatternGosperGliderGun gun;
+    std::vector<Result> results;
+
+    for (auto size : options.sizes)
+    {
+        for (auto density : options.densities)
+        {
+            PatternBitmap soup = makeSoup(size, density);
+            for (auto kernel : kernels)
+            {
+                results.push_back(runScenario({ "soup", density, size, kernel }, options, soup));
+            }
+        }
+        for (auto kernel : kernels)
+        {
+            results.push_back(runScenario({ "acorn", 0, size, kernel }, options, acorn));
+            results.push_back(runScenario({ "gosper-glider-gun", 0, size, kernel }, options, gun));
+        }
+    }
+
+    if (options.format == "json")
+    {
+        printJson(results, options);
+    }
+    else
+    {
+        printCsv(results, options);
+    }
+
+    return 0;
+}
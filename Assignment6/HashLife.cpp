@@ -0,0 +1,457 @@
+#include "HashLife.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const std::uint32_t DEAD_LEAF = 0;
+    const std::uint32_t ALIVE_LEAF = 1;
+    const std::uint8_t INITIAL_LEVEL = 3;
+
+    std::uint64_t slowResultKey(std::uint32_t node, std::uint64_t step)
+    {
+        return (std::uint64_t{ node } << 8) | step;
+    }
+}
+
+HashLife::HashLife(const LifeRule& rule) :
+    m_rule(rule)
+{
+    if (rule.isBorn(0))
+    {
+        throw std::invalid_argument("An unbounded universe cannot use B0 rule " + rule.toString());
+    }
+    if (rule.getStates() > 2)
+    {
+        throw std::invalid_argument("Generations rule " + rule.toString() + " needs LifeSimulator");
+    }
+    m_nodes.push_back({ NO_NODE, NO_NODE, NO_NODE, NO_NODE, NO_NODE, 0, 0 });
+    m_nodes.push_back({ NO_NODE, NO_NODE, NO_NODE, NO_NODE, NO_NODE, 0, 1 });
+    m_table.resize(1024, NO_NODE);
+    m_root = emptyNode(INITIAL_LEVEL);
+}
+
+void HashLife::insertPattern(const Pattern& pattern, std::int64_t startX, std::int64_t startY)
+{
+    std::int64_t endX = startX + pattern.getSizeX();
+    std::int64_t endY = startY + pattern.getSizeY();
+
+    // The root covers [-half, half) on both axes; grow it until the whole pattern fits
+    while (true)
+    {
+        std::int64_t half = std::int64_t{ 1 } << (m_nodes[m_root].level - 1);
+        if (startX >= -half && startY >= -half && endX <= half && endY <= half)
+        {
+            break;
+        }
+        m_root = expand(m_root);
+    }
+
+    std::int64_t half = std::int64_t{ 1 } << (m_nodes[m_root].level - 1);
+    for (std::uint32_t y = 0; y < pattern.getSizeY(); y++)
+    {
+        for (std::uint32_t x = 0; x < pattern.getSizeX(); x++)
+        {
+            bool value = pattern.getCell(x, y);
+            if (this->getCell(startX + x, startY + y) != value)
+            {
+                m_root = setCell(m_root, startX + x + half, startY + y + half, value);
+            }
+        }
+    }
+}
+
+void HashLife::advance(std::uint64_t generations)
+{
+    for (std::uint8_t step = 0; step < 64; step++)
+    {
+        if ((generations >> step) & 1)
+        {
+            if (m_nodes.size() > m_nodeLimit)
+            {
+                this->collectGarbage();
+            }
+            this->stepPowerOfTwo(step);
+        }
+    }
+}
+
+bool HashLife::getCell(std::int64_t x, std::int64_t y) const
+{
+    std::uint32_t node = m_root;
+    std::int64_t half = std::int64_t{ 1 } << (m_nodes[node].level - 1);
+
+    if (x < -half || y < -half || x >= half || y >= half)
+    {
+        return false;
+    }
+
+    x += half;
+    y += half;
+    while (m_nodes[node].level > 0 && m_nodes[node].population > 0)
+    {
+        const Node& current = m_nodes[node];
+        std::int64_t childSize = std::int64_t{ 1 } << (current.level - 1);
+        bool east = x >= childSize;
+        bool south = y >= childSize;
+
+        node = south ? (east ? current.se : current.sw) : (east ? current.ne : current.nw);
+        x -= east ? childSize : 0;
+        y -= south ? childSize : 0;
+    }
+    return node == ALIVE_LEAF;
+}
+
+std::uint64_t HashLife::getGeneration() const
+{
+    return m_generation;
+}
+
+std::uint64_t HashLife::getPopulation() const
+{
+    return m_nodes[m_root].population;
+}
+
+void HashLife::setNodeLimit(std::size_t nodeLimit)
+{
+    m_nodeLimit = nodeLimit;
+}
+
+std::size_t HashLife::getNodeCount() const
+{
+    return m_nodes.size();
+}
+
+void HashLife::collectGarbage()
+{
+    std::vector<std::uint8_t> marked(m_nodes.size(), 0);
+    std::vector<std::uint32_t> pending = { m_root };
+
+    marked[DEAD_LEAF] = 1;
+    marked[ALIVE_LEAF] = 1;
+    while (!pending.empty())
+    {
+        std::uint32_t node = pending.back();
+        pending.pop_back();
+        if (marked[node])
+        {
+            continue;
+        }
+        marked[node] = 1;
+
+        const Node& current = m_nodes[node];
+        pending.insert(pending.end(), { current.nw, current.ne, current.sw, current.se });
+    }
+
+    // Children are always created before their parents, so compacting in order keeps that true
+    std::vector<std::uint32_t> remap(m_nodes.size(), NO_NODE);
+    std::size_t kept = 0;
+    for (std::size_t node = 0; node < m_nodes.size(); node++)
+    {
+        if (marked[node])
+        {
+            remap[node] = static_cast<std::uint32_t>(kept);
+            m_nodes[kept++] = m_nodes[node];
+        }
+    }
+    m_nodes.resize(kept);
+
+    std::fill(m_table.begin(), m_table.end(), NO_NODE);
+    for (std::uint32_t node = 0; node < m_nodes.size(); node++)
+    {
+        Node& current = m_nodes[node];
+        if (current.level > 0)
+        {
+            current.nw = remap[current.nw];
+            current.ne = remap[current.ne];
+            current.sw = remap[current.sw];
+            current.se = remap[current.se];
+            this->insertIntoTable(node);
+        }
+        // A remembered future survives only if its node did
+        current.result = current.result != NO_NODE ? remap[current.result] : NO_NODE;
+    }
+
+    std::unordered_map<std::uint64_t, std::uint32_t> slowResults;
+    for (const auto& [key, result] : m_slowResults)
+    {
+        std::uint32_t node = remap[key >> 8];
+        if (node != NO_NODE && remap[result] != NO_NODE)
+        {
+            slowResults.emplace(slowResultKey(node, key & 0xff), remap[result]);
+        }
+    }
+    m_slowResults = std::move(slowResults);
+
+    m_root = remap[m_root];
+    m_emptyNodes.clear();
+}
+
+std::uint32_t HashLife::join(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se)
+{
+    std::size_t mask = m_table.size() - 1;
+    std::size_t slot = hashChildren(nw, ne, sw, se) & mask;
+
+    while (m_table[slot] != NO_NODE)
+    {
+        const Node& candidate = m_nodes[m_table[slot]];
+        if (candidate.nw == nw && candidate.ne == ne && candidate.sw == sw && candidate.se == se)
+        {
+            return m_table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    std::uint64_t population = m_nodes[nw].population + m_nodes[ne].population + m_nodes[sw].population + m_nodes[se].population;
+    std::uint8_t level = static_cast<std::uint8_t>(m_nodes[nw].level + 1);
+    std::uint32_t node = static_cast<std::uint32_t>(m_nodes.size());
+
+    m_nodes.push_back({ nw, ne, sw, se, NO_NODE, level, population });
+    m_table[slot] = node;
+    if (m_nodes.size() * 2 > m_table.size())
+    {
+        this->growTable();
+    }
+    return node;
+}
+
+std::uint32_t HashLife::emptyNode(std::uint8_t level)
+{
+    if (m_emptyNodes.empty())
+    {
+        m_emptyNodes.push_back(DEAD_LEAF);
+    }
+    while (m_emptyNodes.size() <= level)
+    {
+        std::uint32_t child = m_emptyNodes.back();
+        m_emptyNodes.push_back(join(child, child, child, child));
+    }
+    return m_emptyNodes[level];
+}
+
+std::uint32_t HashLife::expand(std::uint32_t node)
+{
+    // Wraps the node in a border of empty space one level up, keeping it centred
+    Node current = m_nodes[node];
+    std::uint32_t empty = emptyNode(static_cast<std::uint8_t>(current.level - 1));
+
+    return join(join(empty, empty, empty, current.nw),
+                join(empty, empty, current.ne, empty),
+                join(empty, current.sw, empty, empty),
+                join(current.se, empty, empty, empty));
+}
+
+std::uint32_t HashLife::centre(std::uint32_t node)
+{
+    Node current = m_nodes[node];
+    return join(m_nodes[current.nw].se, m_nodes[current.ne].sw, m_nodes[current.sw].ne, m_nodes[current.se].nw);
+}
+
+std::uint32_t HashLife::centreHorizontal(std::uint32_t west, std::uint32_t east)
+{
+    Node w = m_nodes[west];
+    Node e = m_nodes[east];
+    return join(w.ne, e.nw, w.se, e.sw);
+}
+
+std::uint32_t HashLife::centreVertical(std::uint32_t north, std::uint32_t south)
+{
+    Node n = m_nodes[north];
+    Node s = m_nodes[south];
+    return join(n.sw, n.se, s.nw, s.ne);
+}
+
+std::uint32_t HashLife::successor(std::uint32_t node, std::uint8_t step)
+{
+    Node current = m_nodes[node];
+
+    if (current.population == 0)
+    {
+        return emptyNode(static_cast<std::uint8_t>(current.level - 1));
+    }
+    // advance() mixes step sizes, so each size is remembered separately
+    bool fullSpeed = step == current.level - 2;
+    if (fullSpeed && current.result != NO_NODE)
+    {
+        return current.result;
+    }
+    if (!fullSpeed)
+    {
+        auto found = m_slowResults.find(slowResultKey(node, step));
+        if (found != m_slowResults.end())
+        {
+            return found->second;
+        }
+    }
+
+    std::uint32_t result;
+    if (current.level == 2)
+    {
+        result = successorLevel2(node);
+    }
+    else
+    {
+        // Nine overlapping squares one level down tile the node with half-square offsets
+        std::array<std::uint32_t, 9> parts = {
+            current.nw, centreHorizontal(current.nw, current.ne), current.ne,
+            centreVertical(current.nw, current.sw), centre(node), centreVertical(current.ne, current.se),
+            current.sw, centreHorizontal(current.sw, current.se), current.se
+        };
+
+        // A full-speed step advances both halves; a shorter one only advances the second half
+        std::uint8_t innerLevel = static_cast<std::uint8_t>(current.level - 3);
+        for (auto& part : parts)
+        {
+            part = fullSpeed ? successor(part, innerLevel) : centre(part);
+        }
+
+        std::uint8_t innerStep = std::min(step, innerLevel);
+        std::uint32_t nw = successor(join(parts[0], parts[1], parts[3], parts[4]), innerStep);
+        std::uint32_t ne = successor(join(parts[1], parts[2], parts[4], parts[5]), innerStep);
+        std::uint32_t sw = successor(join(parts[3], parts[4], parts[6], parts[7]), innerStep);
+        std::uint32_t se = successor(join(parts[4], parts[5], parts[7], parts[8]), innerStep);
+        result = join(nw, ne, sw, se);
+    }
+
+    if (fullSpeed)
+    {
+        m_nodes[node].result = result;
+    }
+    else
+    {
+        m_slowResults[slowResultKey(node, step)] = result;
+    }
+    return result;
+}
+
+std::uint32_t HashLife::successorLevel2(std::uint32_t node)
+{
+    // Unpack the 4x4 square into rows of four bits and step its centre 2x2 by one generation
+    const Node& current = m_nodes[node];
+    std::array<std::uint32_t, 4> quadrants = { current.nw, current.ne, current.sw, current.se };
+    std::array<std::uint32_t, 4> rows = { 0, 0, 0, 0 };
+
+    for (std::size_t quadrant = 0; quadrant < 4; quadrant++)
+    {
+        const Node& child = m_nodes[quadrants[quadrant]];
+        std::size_t row = (quadrant / 2) * 2;
+        std::size_t shift = (quadrant % 2) * 2;
+
+        rows[row] |= (child.nw << shift) | (child.ne << (shift + 1));
+        rows[row + 1] |= (child.sw << shift) | (child.se << (shift + 1));
+    }
+
+    std::array<std::uint32_t, 4> next = { DEAD_LEAF, DEAD_LEAF, DEAD_LEAF, DEAD_LEAF };
+    for (std::size_t y = 1; y <= 2; y++)
+    {
+        for (std::size_t x = 1; x <= 2; x++)
+        {
+            int count = 0;
+            for (std::size_t ny = y - 1; ny <= y + 1; ny++)
+            {
+                for (std::size_t nx = x - 1; nx <= x + 1; nx++)
+                {
+                    count += (rows[ny] >> nx) & 1;
+                }
+            }
+            bool alive = (rows[y] >> x) & 1;
+            count -= alive;
+            next[(y - 1) * 2 + (x - 1)] = (alive ? m_rule.survives(count) : m_rule.isBorn(count)) ? ALIVE_LEAF : DEAD_LEAF;
+        }
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+std::uint32_t HashLife::setCell(std::uint32_t node, std::int64_t x, std::int64_t y, bool value)
+{
+    Node current = m_nodes[node];
+
+    if (current.level == 0)
+    {
+        return value ? ALIVE_LEAF : DEAD_LEAF;
+    }
+
+    std::int64_t childSize = std::int64_t{ 1 } << (current.level - 1);
+    if (y < childSize)
+    {
+        if (x < childSize)
+        {
+            current.nw = setCell(current.nw, x, y, value);
+        }
+        else
+        {
+            current.ne = setCell(current.ne, x - childSize, y, value);
+        }
+    }
+    else
+    {
+        if (x < childSize)
+        {
+            current.sw = setCell(current.sw, x, y - childSize, value);
+        }
+        else
+        {
+            current.se = setCell(current.se, x - childSize, y - childSize, value);
+        }
+    }
+    return join(current.nw, current.ne, current.sw, current.se);
+}
+
+void HashLife::stepPowerOfTwo(std::uint8_t step)
+{
+    // Pad until the pattern sits in the middle quarter of a node big enough for the step; then
+    // one more level guarantees nothing can travel out of the part of the root that is computed
+    while (true)
+    {
+        // centre() may grow m_nodes, so it runs before anything is read from the vector
+        std::uint32_t middle = centre(centre(m_root));
+        if (m_nodes[m_root].level >= std::max(step + 2, 3) && m_nodes[middle].population == m_nodes[m_root].population)
+        {
+            break;
+        }
+        m_root = expand(m_root);
+    }
+    m_root = expand(m_root);
+    m_root = successor(m_root, step);
+    m_generation += std::uint64_t{ 1 } << step;
+}
+
+void HashLife::growTable()
+{
+    m_table.assign(m_table.size() * 2, NO_NODE);
+    for (std::uint32_t node = 0; node < m_nodes.size(); node++)
+    {
+        if (m_nodes[node].level > 0)
+        {
+            this->insertIntoTable(node);
+        }
+    }
+}
+
+void HashLife::insertIntoTable(std::uint32_t node)
+{
+    const Node& current = m_nodes[node];
+    std::size_t mask = m_table.size() - 1;
+    std::size_t slot = hashChildren(current.nw, current.ne, current.sw, current.se) & mask;
+
+    while (m_table[slot] != NO_NODE)
+    {
+        slot = (slot + 1) & mask;
+    }
+    m_table[slot] = node;
+}
+
+std::size_t HashLife::hashChildren(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se)
+{
+    std::uint64_t hash = nw;
+    hash = hash * 0x9e3779b97f4a7c15 + ne;
+    hash = hash * 0x9e3779b97f4a7c15 + sw;
+    hash = hash * 0x9e3779b97f4a7c15 + se;
+    return static_cast<std::size_t>(hash ^ (hash >> 29));
+}
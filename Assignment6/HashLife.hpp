@@ -0,0 +1,71 @@
+#pragma once
+#include "LifeRule.hpp"
+#include "Pattern.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Unbounded Life universe stored as a canonical quadtree. Identical squares share one node and
+// every node remembers its future, so periodic patterns can be advanced by huge steps at once.
+class HashLife
+{
+  public:
+    // Rules with B0 fill infinite space in one generation and throw std::invalid_argument, as do
+    // Generations rules
+    HashLife(const LifeRule& rule = LifeRule());
+
+    void insertPattern(const Pattern& pattern, std::int64_t startX, std::int64_t startY);
+    void advance(std::uint64_t generations);
+
+    bool getCell(std::int64_t x, std::int64_t y) const;
+    std::uint64_t getGeneration() const;
+    std::uint64_t getPopulation() const;
+
+    // Unreachable nodes are freed once the cache holds more than this many nodes
+    void setNodeLimit(std::size_t nodeLimit);
+    std::size_t getNodeCount() const;
+    void collectGarbage();
+
+  private:
+    static constexpr std::uint32_t NO_NODE = 0xffffffff;
+
+    class Node
+    {
+      public:
+        std::uint32_t nw;
+        std::uint32_t ne;
+        std::uint32_t sw;
+        std::uint32_t se;
+        // Centre of this node 2^(level - 2) generations later, one level down
+        std::uint32_t result;
+        std::uint8_t level;
+        std::uint64_t population;
+    };
+
+    LifeRule m_rule;
+    std::vector<Node> m_nodes;
+    // Open addressing table of node indices keyed by the four children
+    std::vector<std::uint32_t> m_table;
+    std::vector<std::uint32_t> m_emptyNodes;
+    // Results of steps shorter than a node's full speed, keyed by node index and step
+    std::unordered_map<std::uint64_t, std::uint32_t> m_slowResults;
+    std::uint32_t m_root;
+    std::uint64_t m_generation = 0;
+    std::size_t m_nodeLimit = 1 << 22;
+
+    std::uint32_t join(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se);
+    std::uint32_t emptyNode(std::uint8_t level);
+    std::uint32_t expand(std::uint32_t node);
+    std::uint32_t centre(std::uint32_t node);
+    std::uint32_t centreHorizontal(std::uint32_t west, std::uint32_t east);
+    std::uint32_t centreVertical(std::uint32_t north, std::uint32_t south);
+    std::uint32_t successor(std::uint32_t node, std::uint8_t step);
+    std::uint32_t successorLevel2(std::uint32_t node);
+    std::uint32_t setCell(std::uint32_t node, std::int64_t x, std::int64_t y, bool value);
+    void stepPowerOfTwo(std::uint8_t step);
+    void growTable();
+    void insertIntoTable(std::uint32_t node);
+    static std::size_t hashChildren(std::uint32_t nw, std::uint32_t ne, std::uint32_t sw, std::uint32_t se);
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+// What lies beyond the edges of a finite board
+enum class LifeBoundary
+{
+    // Every cell past the edge is dead
+    Dead,
+    // The board wraps around, so the left edge neighbours the right and the top the bottom
+    Torus,
+    // The edge is a mirror: the cell just past it is a copy of the cell just inside
+    Mirror
+};
@@ -0,0 +1,80 @@
+#include "LifeFrame.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+void LifeFrame::capture(const LifeSimulator& simulation)
+{
+    m_sizeX = simulation.getSizeX();
+    m_sizeY = simulation.getSizeY();
+    m_wordsPerRow = simulation.getWordsPerRow();
+    m_generation = simulation.getGeneration();
+    m_rows.resize(m_wordsPerRow * m_sizeY);
+
+    for (std::uint32_t y = 0; y < m_sizeY; y++)
+    {
+        std::copy(simulation.getRow(y), simulation.getRow(y) + m_wordsPerRow, m_rows.begin() + y * m_wordsPerRow);
+    }
+
+    if (m_sizeY == 0 || simulation.getDecayingRow(0) == nullptr)
+    {
+        m_decaying.clear();
+        return;
+    }
+
+    // Only the states of decaying cells are copied; the rest are never read
+    m_decaying.resize(m_rows.size());
+    m_ages.resize(m_rows.size() * 64);
+    for (std::uint32_t y = 0; y < m_sizeY; y++)
+    {
+        const std::uint64_t* decaying = simulation.getDecayingRow(y);
+        std::copy(decaying, decaying + m_wordsPerRow, m_decaying.begin() + y * m_wordsPerRow);
+        for (std::size_t word = 0; word < m_wordsPerRow; word++)
+        {
+            for (std::uint64_t bits = decaying[word]; bits != 0; bits &= bits - 1)
+            {
+                std::uint32_t x = static_cast<std::uint32_t>(word * 64 + std::countr_zero(bits));
+                m_ages[y * m_wordsPerRow * 64 + x] = simulation.getState(x, y);
+            }
+        }
+    }
+}
+
+std::uint32_t LifeFrame::getSizeX() const
+{
+    return m_sizeX;
+}
+
+std::uint32_t LifeFrame::getSizeY() const
+{
+    return m_sizeY;
+}
+
+const std::uint64_t* LifeFrame::getRow(std::uint32_t y) const
+{
+    return &m_rows[y * m_wordsPerRow];
+}
+
+std::uint64_t LifeFrame::getGeneration() const
+{
+    return m_generation;
+}
+
+std::uint8_t LifeFrame::getState(std::uint32_t x, std::uint32_t y) const
+{
+    if (this->getCell(x, y))
+    {
+        return 1;
+    }
+    if (m_decaying.empty() || ((m_decaying[y * m_wordsPerRow + x / 64] >> (x % 64)) & 1) == 0)
+    {
+        return 0;
+    }
+    return m_ages[y * m_wordsPerRow * 64 + x];
+}
+
+const std::uint64_t* LifeFrame::getDecayingRow(std::uint32_t y) const
+{
+    return m_decaying.empty() ? nullptr : &m_decaying[y * m_wordsPerRow];
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "LifeSimulator.hpp"
+#include "PatternPacked.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A copy of the board at one generation, for handing to another thread. Capturing into the same
+// frame again reuses its buffer, so a stepping loop does not allocate once the size is settled.
+class LifeFrame : public PatternPacked
+{
+  public:
+    void capture(const LifeSimulator& simulation);
+
+    std::uint32_t getSizeX() const override;
+    std::uint32_t getSizeY() const override;
+    const std::uint64_t* getRow(std::uint32_t y) const override;
+    std::uint64_t getGeneration() const;
+    // The same as the simulator's at the time of the capture
+    std::uint8_t getState(std::uint32_t x, std::uint32_t y) const;
+    const std::uint64_t* getDecayingRow(std::uint32_t y) const;
+
+  private:
+    std::uint32_t m_sizeX = 0;
+    std::uint32_t m_sizeY = 0;
+    std::size_t m_wordsPerRow = 0;
+    std::uint64_t m_generation = 0;
+    std::vector<std::uint64_t> m_rows;
+    // Left empty for two-state rules
+    std::vector<std::uint64_t> m_decaying;
+    std::vector<std::uint8_t> m_ages;
+};
@@ -0,0 +1,36 @@
+#include "LifeFrameSlot.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+LifeFrame& LifeFrameSlot::getWriteFrame()
+{
+    return m_frames[m_write];
+}
+
+void LifeFrameSlot::publish()
+{
+    // Release makes the written frame visible to the consumer; acquire hands back a frame the
+    // consumer has finished with
+    m_write = m_middle.exchange(static_cast<std::uint8_t>(m_write | FRESH), std::memory_order_acq_rel) & INDEX;
+}
+
+bool LifeFrameSlot::wantsFrame() const
+{
+    return (m_middle.load(std::memory_order_relaxed) & FRESH) == 0;
+}
+
+bool LifeFrameSlot::takeLatest()
+{
+    if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0)
+    {
+        return false;
+    }
+    m_read = m_middle.exchange(m_read, std::memory_order_acq_rel) & INDEX;
+    return true;
+}
+
+const LifeFrame& LifeFrameSlot::getReadFrame() const
+{
+    return m_frames[m_read];
+}
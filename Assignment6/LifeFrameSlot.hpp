@@ -0,0 +1,36 @@
+#pragma once
+#include "LifeFrame.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+// Hands frames from one producer thread to one consumer thread without locks or allocation.
+// There are three frames: the producer writes one, the consumer reads another, and the third
+// holds the latest published frame. Publishing swaps the written frame into the middle, so a
+// frame the consumer never picked up is simply dropped, and taking a frame swaps it out again.
+// Neither side ever waits for the other.
+class LifeFrameSlot
+{
+  public:
+    // The frame the producer may fill; only valid until the next publish()
+    LifeFrame& getWriteFrame();
+    void publish();
+    // False while the last published frame is still waiting for the consumer, so a producer that
+    // runs faster than the consumer can skip capturing frames that would only be dropped
+    bool wantsFrame() const;
+
+    // Takes the latest published frame if one arrived since the last call and returns true.
+    // getReadFrame() then holds it until the next successful take.
+    bool takeLatest();
+    const LifeFrame& getReadFrame() const;
+
+  private:
+    // The middle frame's index, with FRESH set while it holds a frame the consumer has not taken
+    static constexpr std::uint8_t FRESH = 4;
+    static constexpr std::uint8_t INDEX = 3;
+
+    LifeFrame m_frames[3];
+    std::atomic<std::uint8_t> m_middle = 1;
+    std::uint8_t m_write = 0;
+    std::uint8_t m_read = 2;
+};
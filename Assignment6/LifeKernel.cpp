@@ -0,0 +1,437 @@
+#include "LifeKernel.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(LIFE_KERNEL_X86_64)
+    #include <emmintrin.h>
+    #if defined(_MSC_VER)
+        #include <immintrin.h>
+        #include <intrin.h>
+    #endif
+
+// Lives in LifeKernelAvx2.cpp, which is the only file compiled with AVX2 enabled. Returns how
+// many words it computed, always a multiple of four; the caller finishes the rest of the row.
+std::size_t lifeRowKernelAvx2Blocks(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, std::uint64_t* out, std::uint64_t* changes, std::size_t words, const LifeKernelRule& rule);
+// Measures blocks exactly four words wide
+std::uint32_t lifeTileMeasureAvx2Block(const std::uint64_t* cells, std::size_t stride, std::size_t rows, std::uint64_t* columns, std::uint64_t& liveRows);
+#endif
+
+namespace
+{
+    // Adds three one-bit values in every bit position at once
+    inline void fullAdder(std::uint64_t a, std::uint64_t b, std::uint64_t c, std::uint64_t& sum, std::uint64_t& carry)
+    {
+        std::uint64_t partial = a ^ b;
+        sum = partial ^ c;
+        carry = (a & b) | (partial & c);
+    }
+
+    // Picks whenClear where selector bits are clear and whenSet where they are set
+    inline std::uint64_t select(std::uint64_t selector, std::uint64_t whenClear, std::uint64_t whenSet)
+    {
+        return whenClear ^ (selector & (whenClear ^ whenSet));
+    }
+
+    // Looks up the next state in the compiled rule, one level of selects per bit of the count
+    inline std::uint64_t applyRule(std::uint64_t alive, std::uint64_t bit0, std::uint64_t bit1, std::uint64_t bit2, std::uint64_t bit3, const LifeKernelRule& rule)
+    {
+        std::uint64_t byBit1[4];
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            std::uint64_t bit1Clear = rule.whenBit0Clear[i * 2] ^ (bit0 & rule.whenBit0Differs[i * 2]);
+            std::uint64_t bit1Set = rule.whenBit0Clear[i * 2 + 1] ^ (bit0 & rule.whenBit0Differs[i * 2 + 1]);
+            byBit1[i] = select(bit1, bit1Clear, bit1Set);
+        }
+
+        std::uint64_t next = select(alive, select(bit2, byBit1[0], byBit1[1]), select(bit2, byBit1[2], byBit1[3]));
+        return select(bit3, next, select(alive, rule.deadWithEight, rule.aliveWithEight));
+    }
+
+    template <bool Conway>
+    inline std::uint64_t nextWord(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, const LifeKernelRule& rule)
+    {
+        std::uint64_t upLeft = (up[0] << 1) | (up[-1] >> 63);
+        std::uint64_t upRight = (up[0] >> 1) | (up[1] << 63);
+        std::uint64_t left = (mid[0] << 1) | (mid[-1] >> 63);
+        std::uint64_t right = (mid[0] >> 1) | (mid[1] << 63);
+        std::uint64_t downLeft = (down[0] << 1) | (down[-1] >> 63);
+        std::uint64_t downRight = (down[0] >> 1) | (down[1] << 63);
+
+        std::uint64_t sumA, carryA, sumB, carryB, sumC, carryC;
+        fullAdder(upLeft, up[0], upRight, sumA, carryA);
+        fullAdder(left, right, downLeft, sumB, carryB);
+        sumC = down[0] ^ downRight;
+        carryC = down[0] & downRight;
+
+        std::uint64_t bit0, carryD;
+        fullAdder(sumA, sumB, sumC, bit0, carryD);
+
+        std::uint64_t twos, fours;
+        fullAdder(carryA, carryB, carryC, twos, fours);
+        std::uint64_t bit1 = twos ^ carryD;
+        std::uint64_t bit2 = fours ^ (twos & carryD);
+
+        if constexpr (Conway)
+        {
+            // Alive next generation with exactly three neighbours, or two neighbours and already alive
+            return bit1 & ~bit2 & (bit0 | mid[0]);
+        }
+        else
+        {
+            std::uint64_t bit3 = fours & twos & carryD;
+            return applyRule(mid[0], bit0, bit1, bit2, bit3, rule);
+        }
+    }
+
+    template <bool Conway>
+    void lifeRowKernelScalar(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, std::uint64_t* out, std::uint64_t* changes, std::size_t words, const LifeKernelRule& rule)
+    {
+        // `out` could alias the rule as far as the compiler knows, so copy it to keep the masks in registers
+        const LifeKernelRule local = rule;
+        for (std::size_t i = 0; i < words; i++)
+        {
+            out[i] = nextWord<Conway>(up + i, mid + i, down + i, local);
+            changes[i] |= out[i] ^ mid[i];
+        }
+    }
+
+    std::uint32_t lifeTileMeasureScalar(const std::uint64_t* cells, std::size_t stride, std::size_t words, std::size_t rows, std::uint64_t* columns, std::uint64_t& liveRows)
+    {
+        std::uint32_t population = 0;
+        liveRows = 0;
+        std::fill(columns, columns + words, 0);
+
+        for (std::size_t y = 0; y < rows; y++)
+        {
+            const std::uint64_t* row = cells + y * stride;
+            std::uint64_t any = 0;
+            for (std::size_t i = 0; i < words; i++)
+            {
+                population += std::popcount(row[i]);
+                columns[i] |= row[i];
+                any |= row[i];
+            }
+            liveRows |= static_cast<std::uint64_t>(any != 0) << y;
+        }
+        return population;
+    }
+
+    void lifeDecayKernelScalar(const std::uint64_t* mid, std::uint64_t* out, std::uint64_t* changes, std::uint64_t* decaying, std::uint8_t* ages, std::size_t words, std::uint8_t states)
+    {
+        for (std::size_t i = 0; i < words; i++)
+        {
+            out[i] &= ~decaying[i];
+            std::uint64_t leaving = mid[i] & ~out[i];
+            if ((decaying[i] | leaving) == 0)
+            {
+                continue;
+            }
+
+            std::uint8_t* wordAges = ages + i * 64;
+            std::uint64_t next = 0;
+            for (std::size_t bit = 0; bit < 64; bit++)
+            {
+                std::uint8_t age = wordAges[bit];
+                if (age != 0)
+                {
+                    age = (age + 1 == states) ? 0 : static_cast<std::uint8_t>(age + 1);
+                }
+                else if ((leaving >> bit) & 1)
+                {
+                    age = 2;
+                }
+                wordAges[bit] = age;
+                next |= static_cast<std::uint64_t>(age != 0) << bit;
+            }
+            decaying[i] = next;
+            changes[i] |= next;
+        }
+    }
+
+#if defined(LIFE_KERNEL_X86_64)
+    inline void fullAdder(__m128i a, __m128i b, __m128i c, __m128i& sum, __m128i& carry)
+    {
+        __m128i partial = _mm_xor_si128(a, b);
+        sum = _mm_xor_si128(partial, c);
+        carry = _mm_or_si128(_mm_and_si128(a, b), _mm_and_si128(partial, c));
+    }
+
+    // Neighbours to the left of each cell, pulling in the top bit of the previous word
+    inline __m128i shiftedLeft(const std::uint64_t* row)
+    {
+        __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+        __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row - 1));
+        return _mm_or_si128(_mm_slli_epi64(words, 1), _mm_srli_epi64(previous, 63));
+    }
+
+    // Neighbours to the right of each cell, pulling in the bottom bit of the next word
+    inline __m128i shiftedRight(const std::uint64_t* row)
+    {
+        __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+        __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 1));
+        return _mm_or_si128(_mm_srli_epi64(words, 1), _mm_slli_epi64(next, 63));
+    }
+
+    inline __m128i select(__m128i selector, __m128i whenClear, __m128i whenSet)
+    {
+        return _mm_xor_si128(whenClear, _mm_and_si128(selector, _mm_xor_si128(whenClear, whenSet)));
+    }
+
+    // LifeKernelRule with every mask broadcast across a register
+    class RuleVectors
+    {
+      public:
+        explicit RuleVectors(const LifeKernelRule& rule)
+        {
+            for (std::size_t i = 0; i < 8; i++)
+            {
+                whenBit0Clear[i] = _mm_set1_epi64x(static_cast<long long>(rule.whenBit0Clear[i]));
+                whenBit0Differs[i] = _mm_set1_epi64x(static_cast<long long>(rule.whenBit0Differs[i]));
+            }
+            deadWithEight = _mm_set1_epi64x(static_cast<long long>(rule.deadWithEight));
+            aliveWithEight = _mm_set1_epi64x(static_cast<long long>(rule.aliveWithEight));
+        }
+
+        __m128i whenBit0Clear[8];
+        __m128i whenBit0Differs[8];
+        __m128i deadWithEight;
+        __m128i aliveWithEight;
+    };
+
+    inline __m128i applyRule(__m128i alive, __m128i bit0, __m128i bit1, __m128i bit2, __m128i bit3, const RuleVectors& rule)
+    {
+        __m128i byBit1[4];
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            __m128i bit1Clear = _mm_xor_si128(rule.whenBit0Clear[i * 2], _mm_and_si128(bit0, rule.whenBit0Differs[i * 2]));
+            __m128i bit1Set = _mm_xor_si128(rule.whenBit0Clear[i * 2 + 1], _mm_and_si128(bit0, rule.whenBit0Differs[i * 2 + 1]));
+            byBit1[i] = select(bit1, bit1Clear, bit1Set);
+        }
+
+        __m128i next = select(alive, select(bit2, byBit1[0], byBit1[1]), select(bit2, byBit1[2], byBit1[3]));
+        return select(bit3, next, select(alive, rule.deadWithEight, rule.aliveWithEight));
+    }
+
+    // Same bit-sliced adder tree as nextWord, 128 cells at a time
+    template <bool Conway>
+    void lifeRowKernelSse2(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, std::uint64_t* out, std::uint64_t* changes, std::size_t words, const LifeKernelRule& rule)
+    {
+        const RuleVectors vectors(rule);
+        std::size_t i = 0;
+        for (; i + 2 <= words; i += 2)
+        {
+            __m128i upCenter = _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + i));
+            __m128i center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(mid + i));
+            __m128i downCenter = _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + i));
+            __m128i downRight = shiftedRight(down + i);
+
+            __m128i sumA, carryA, sumB, carryB;
+            fullAdder(shiftedLeft(up + i), upCenter, shiftedRight(up + i), sumA, carryA);
+            fullAdder(shiftedLeft(mid + i), shiftedRight(mid + i), shiftedLeft(down + i), sumB, carryB);
+            __m128i sumC = _mm_xor_si128(downCenter, downRight);
+            __m128i carryC = _mm_and_si128(downCenter, downRight);
+
+            __m128i bit0, carryD;
+            fullAdder(sumA, sumB, sumC, bit0, carryD);
+
+            __m128i twos, fours;
+            fullAdder(carryA, carryB, carryC, twos, fours);
+            __m128i bit1 = _mm_xor_si128(twos, carryD);
+            __m128i bit2 = _mm_xor_si128(fours, _mm_and_si128(twos, carryD));
+
+            __m128i alive;
+            if constexpr (Conway)
+            {
+                alive = _mm_andnot_si128(bit2, _mm_and_si128(bit1, _mm_or_si128(bit0, center)));
+            }
+            else
+            {
+                __m128i bit3 = _mm_and_si128(fours, _mm_and_si128(twos, carryD));
+                alive = applyRule(center, bit0, bit1, bit2, bit3, vectors);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), alive);
+
+            __m128i changed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(changes + i));
+            changed = _mm_or_si128(changed, _mm_xor_si128(alive, center));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(changes + i), changed);
+        }
+        lifeRowKernelScalar<Conway>(up + i, mid + i, down + i, out + i, changes + i, words - i, rule);
+    }
+
+    template <bool Conway>
+    void lifeRowKernelAvx2(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, std::uint64_t* out, std::uint64_t* changes, std::size_t words, const LifeKernelRule& rule)
+    {
+        std::size_t i = lifeRowKernelAvx2Blocks(up, mid, down, out, changes, words, rule);
+        lifeRowKernelSse2<Conway>(up + i, mid + i, down + i, out + i, changes + i, words - i, rule);
+    }
+
+    // Sixteen cells at a time: the bits of the word are spread out to one byte mask per cell
+    void lifeDecayKernelSse2(const std::uint64_t* mid, std::uint64_t* out, std::uint64_t* changes, std::uint64_t* decaying, std::uint8_t* ages, std::size_t words, std::uint8_t states)
+    {
+        const __m128i bitInByte = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i two = _mm_set1_epi8(2);
+        const __m128i last = _mm_set1_epi8(static_cast<char>(states));
+
+        for (std::size_t i = 0; i < words; i++)
+        {
+            out[i] &= ~decaying[i];
+            std::uint64_t leaving = mid[i] & ~out[i];
+            if ((decaying[i] | leaving) == 0)
+            {
+                continue;
+            }
+
+            std::uint64_t next = 0;
+            for (std::size_t chunk = 0; chunk < 4; chunk++)
+            {
+                __m128i* chunkAges = reinterpret_cast<__m128i*>(ages + i * 64 + chunk * 16);
+                __m128i spread = _mm_cvtsi32_si128(static_cast<int>((leaving >> (chunk * 16)) & 0xffff));
+                spread = _mm_unpacklo_epi8(spread, spread);
+                spread = _mm_unpacklo_epi16(spread, spread);
+                spread = _mm_unpacklo_epi32(spread, spread);
+                __m128i starting = _mm_cmpeq_epi8(_mm_and_si128(spread, bitInByte), bitInByte);
+
+                __m128i age = _mm_loadu_si128(chunkAges);
+                __m128i notDecaying = _mm_cmpeq_epi8(age, zero);
+                __m128i older = _mm_add_epi8(age, one);
+                older = _mm_andnot_si128(_mm_or_si128(_mm_cmpeq_epi8(older, last), notDecaying), older);
+                age = _mm_or_si128(older, _mm_and_si128(starting, two));
+                _mm_storeu_si128(chunkAges, age);
+
+                std::uint64_t stillDecaying = static_cast<std::uint64_t>(~_mm_movemask_epi8(_mm_cmpeq_epi8(age, zero)) & 0xffff);
+                next |= stillDecaying << (chunk * 16);
+            }
+            decaying[i] = next;
+            changes[i] |= next;
+        }
+    }
+
+    std::uint32_t lifeTileMeasureAvx2(const std::uint64_t* cells, std::size_t stride, std::size_t words, std::size_t rows, std::uint64_t* columns, std::uint64_t& liveRows)
+    {
+        if (words == 4)
+        {
+            return lifeTileMeasureAvx2Block(cells, stride, rows, columns, liveRows);
+        }
+        return lifeTileMeasureScalar(cells, stride, words, rows, columns, liveRows);
+    }
+
+    bool cpuSupportsAvx2()
+    {
+    #if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7)
+        {
+            return false;
+        }
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+        __cpuidex(info, 7, 0);
+        return osSavesYmm && (info[1] & (1 << 5)) != 0;
+    #else
+        return __builtin_cpu_supports("avx2");
+    #endif
+    }
+#endif
+}
+
+bool isLifeKernelSupported(LifeKernelType type)
+{
+    switch (type)
+    {
+        case LifeKernelType::Scalar:
+            return true;
+#if defined(LIFE_KERNEL_X86_64)
+        case LifeKernelType::Sse2:
+            return true;
+        case LifeKernelType::Avx2:
+        {
+            static const bool supported = cpuSupportsAvx2();
+            return supported;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+LifeKernelType detectLifeKernel()
+{
+    if (isLifeKernelSupported(LifeKernelType::Avx2))
+    {
+        return LifeKernelType::Avx2;
+    }
+    if (isLifeKernelSupported(LifeKernelType::Sse2))
+    {
+        return LifeKernelType::Sse2;
+    }
+    return LifeKernelType::Scalar;
+}
+
+LifeKernelRule::LifeKernelRule(std::uint16_t birthCounts, std::uint16_t survivalCounts)
+{
+    conway = birthCounts == (1 << 3) && survivalCounts == ((1 << 2) | (1 << 3));
+
+    auto nextState = [=](std::size_t alive, std::size_t neighbours) -> std::uint64_t
+    {
+        std::uint16_t counts = alive ? survivalCounts : birthCounts;
+        return ((counts >> neighbours) & 1) ? ~std::uint64_t{ 0 } : 0;
+    };
+
+    for (std::size_t i = 0; i < 8; i++)
+    {
+        std::size_t alive = i / 4;
+        std::size_t neighbours = (i % 4) * 2;
+        whenBit0Clear[i] = nextState(alive, neighbours);
+        whenBit0Differs[i] = nextState(alive, neighbours) ^ nextState(alive, neighbours + 1);
+    }
+    deadWithEight = nextState(0, 8);
+    aliveWithEight = nextState(1, 8);
+}
+
+LifeRowKernel getLifeRowKernel(LifeKernelType type, const LifeKernelRule& rule)
+{
+    if (!isLifeKernelSupported(type))
+    {
+        type = LifeKernelType::Scalar;
+    }
+
+    switch (type)
+    {
+#if defined(LIFE_KERNEL_X86_64)
+        case LifeKernelType::Sse2:
+            return rule.conway ? lifeRowKernelSse2<true> : lifeRowKernelSse2<false>;
+        case LifeKernelType::Avx2:
+            return rule.conway ? lifeRowKernelAvx2<true> : lifeRowKernelAvx2<false>;
+#endif
+        default:
+            return rule.conway ? lifeRowKernelScalar<true> : lifeRowKernelScalar<false>;
+    }
+}
+
+LifeTileMeasure getLifeTileMeasure(LifeKernelType type)
+{
+#if defined(LIFE_KERNEL_X86_64)
+    if (type == LifeKernelType::Avx2 && isLifeKernelSupported(type))
+    {
+        return lifeTileMeasureAvx2;
+    }
+#endif
+    return lifeTileMeasureScalar;
+}
+
+LifeDecayKernel getLifeDecayKernel(LifeKernelType type)
+{
+#if defined(LIFE_KERNEL_X86_64)
+    if (type != LifeKernelType::Scalar && isLifeKernelSupported(type))
+    {
+        return lifeDecayKernelSse2;
+    }
+#endif
+    return lifeDecayKernelScalar;
+}
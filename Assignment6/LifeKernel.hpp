@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define LIFE_KERNEL_X86_64
+#endif
+
+enum class LifeKernelType
+{
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// A rule compiled for the kernels. Every mask is all ones or all zeros, and the kernels pick
+// between them with the bit-sliced neighbour count, so any rule costs the same few operations.
+// Plain arrays keep std templates out of LifeKernelAvx2.cpp.
+class LifeKernelRule
+{
+  public:
+    // Bit n of the counts is set when a cell with n live neighbours is born, or survives
+    LifeKernelRule(std::uint16_t birthCounts, std::uint16_t survivalCounts);
+
+    // Conway's Life has its own hard-coded kernels
+    bool conway;
+    // Indexed by alive * 4 + bit2 * 2 + bit1 of the count: the next state when bit0 is clear,
+    // and how it differs when bit0 is set
+    std::uint64_t whenBit0Clear[8];
+    std::uint64_t whenBit0Differs[8];
+    // Eight neighbours is the only count with bit3 set
+    std::uint64_t deadWithEight;
+    std::uint64_t aliveWithEight;
+};
+
+// Computes the next generation for `words` consecutive packed words of one row. The pointers
+// address the first word of the rows above, at and below; each row must have one readable
+// word before and after the range for the neighbours on the left and right edges.
+// The bits that changed are OR-ed into `changes` so callers can tell which words are settled.
+using LifeRowKernel = void (*)(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, std::uint64_t* out, std::uint64_t* changes, std::size_t words, const LifeKernelRule& rule);
+
+bool isLifeKernelSupported(LifeKernelType type);
+LifeKernelType detectLifeKernel();
+// Returns the Conway kernel of that type when the rule is Conway's Life
+LifeRowKernel getLifeRowKernel(LifeKernelType type, const LifeKernelRule& rule);
+
+// Measures a block of `rows` rows (at most 64) of `words` packed words each, the rows `stride`
+// words apart. Returns the number of live cells, sets bit y of `liveRows` when row y has a live
+// cell and stores the OR of each word column in `columns`, so callers can find the live extents.
+using LifeTileMeasure = std::uint32_t (*)(const std::uint64_t* cells, std::size_t stride, std::size_t words, std::size_t rows, std::uint64_t* columns, std::uint64_t& liveRows);
+
+LifeTileMeasure getLifeTileMeasure(LifeKernelType type);
+
+// Second pass over a row for Generations rules, run after the row kernel. `decaying` has a bit
+// set for each cell in states 2 and up, whose state is in `ages`, one byte per cell and 0 for
+// cells that are not decaying. Decaying cells cannot be born, so their bits are cleared in `out`;
+// cells that were alive in `mid` and are not in `out` start decaying, and decaying cells move on
+// a state, dying after states - 1. `decaying` and `ages` are updated in place, and the decaying
+// bits are OR-ed into `changes` because those cells change again next generation.
+using LifeDecayKernel = void (*)(const std::uint64_t* mid, std::uint64_t* out, std::uint64_t* changes, std::uint64_t* decaying, std::uint8_t* ages, std::size_t words, std::uint8_t states);
+
+LifeDecayKernel getLifeDecayKernel(LifeKernelType type);
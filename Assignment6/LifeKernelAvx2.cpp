@@ -0,0 +1,154 @@
+#include "LifeKernel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(LIFE_KERNEL_X86_64)
+    #include <immintrin.h>
+
+// Only called after LifeKernel.cpp has checked the CPU supports AVX2. Nothing else in this file
+// may be shared with other translation units, because all of it is compiled for AVX2.
+namespace
+{
+    inline void fullAdder(__m256i a, __m256i b, __m256i c, __m256i& sum, __m256i& carry)
+    {
+        __m256i partial = _mm256_xor_si256(a, b);
+        sum = _mm256_xor_si256(partial, c);
+        carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(partial, c));
+    }
+
+    inline __m256i shiftedLeft(const std::uint64_t* row)
+    {
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+        __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row - 1));
+        return _mm256_or_si256(_mm256_slli_epi64(words, 1), _mm256_srli_epi64(previous, 63));
+    }
+
+    inline __m256i shiftedRight(const std::uint64_t* row)
+    {
+        __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+        __m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + 1));
+        return _mm256_or_si256(_mm256_srli_epi64(words, 1), _mm256_slli_epi64(next, 63));
+    }
+
+    inline __m256i select(__m256i selector, __m256i whenClear, __m256i whenSet)
+    {
+        return _mm256_xor_si256(whenClear, _mm256_and_si256(selector, _mm256_xor_si256(whenClear, whenSet)));
+    }
+
+    class RuleVectors
+    {
+      public:
+        explicit RuleVectors(const LifeKernelRule& rule)
+        {
+            for (std::size_t i = 0; i < 8; i++)
+            {
+                whenBit0Clear[i] = _mm256_set1_epi64x(static_cast<long long>(rule.whenBit0Clear[i]));
+                whenBit0Differs[i] = _mm256_set1_epi64x(static_cast<long long>(rule.whenBit0Differs[i]));
+            }
+            deadWithEight = _mm256_set1_epi64x(static_cast<long long>(rule.deadWithEight));
+            aliveWithEight = _mm256_set1_epi64x(static_cast<long long>(rule.aliveWithEight));
+        }
+
+        __m256i whenBit0Clear[8];
+        __m256i whenBit0Differs[8];
+        __m256i deadWithEight;
+        __m256i aliveWithEight;
+    };
+
+    inline __m256i applyRule(__m256i alive, __m256i bit0, __m256i bit1, __m256i bit2, __m256i bit3, const RuleVectors& rule)
+    {
+        __m256i byBit1[4];
+        for (std::size_t i = 0; i < 4; i++)
+        {
+            __m256i bit1Clear = _mm256_xor_si256(rule.whenBit0Clear[i * 2], _mm256_and_si256(bit0, rule.whenBit0Differs[i * 2]));
+            __m256i bit1Set = _mm256_xor_si256(rule.whenBit0Clear[i * 2 + 1], _mm256_and_si256(bit0, rule.whenBit0Differs[i * 2 + 1]));
+            byBit1[i] = select(bit1, bit1Clear, bit1Set);
+        }
+
+        __m256i next = select(alive, select(bit2, byBit1[0], byBit1[1]), select(bit2, byBit1[2], byBit1[3]));
+        return select(bit3, next, select(alive, rule.deadWithEight, rule.aliveWithEight));
+    }
+
+    template <bool Conway>
+    std::size_t computeBlocks(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, std::uint64_t* out, std::uint64_t* changes, std::size_t words, const LifeKernelRule& rule)
+    {
+        const RuleVectors vectors(rule);
+        std::size_t i = 0;
+        for (; i + 4 <= words; i += 4)
+        {
+            __m256i upCenter = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + i));
+            __m256i center = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mid + i));
+            __m256i downCenter = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + i));
+            __m256i downRight = shiftedRight(down + i);
+
+            __m256i sumA, carryA, sumB, carryB;
+            fullAdder(shiftedLeft(up + i), upCenter, shiftedRight(up + i), sumA, carryA);
+            fullAdder(shiftedLeft(mid + i), shiftedRight(mid + i), shiftedLeft(down + i), sumB, carryB);
+            __m256i sumC = _mm256_xor_si256(downCenter, downRight);
+            __m256i carryC = _mm256_and_si256(downCenter, downRight);
+
+            __m256i bit0, carryD;
+            fullAdder(sumA, sumB, sumC, bit0, carryD);
+
+            __m256i twos, fours;
+            fullAdder(carryA, carryB, carryC, twos, fours);
+            __m256i bit1 = _mm256_xor_si256(twos, carryD);
+            __m256i bit2 = _mm256_xor_si256(fours, _mm256_and_si256(twos, carryD));
+
+            __m256i alive;
+            if constexpr (Conway)
+            {
+                alive = _mm256_andnot_si256(bit2, _mm256_and_si256(bit1, _mm256_or_si256(bit0, center)));
+            }
+            else
+            {
+                __m256i bit3 = _mm256_and_si256(fours, _mm256_and_si256(twos, carryD));
+                alive = applyRule(center, bit0, bit1, bit2, bit3, vectors);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), alive);
+
+            __m256i changed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(changes + i));
+            changed = _mm256_or_si256(changed, _mm256_xor_si256(alive, center));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(changes + i), changed);
+        }
+        return i;
+    }
+}
+
+std::size_t lifeRowKernelAvx2Blocks(const std::uint64_t* up, const std::uint64_t* mid, const std::uint64_t* down, std::uint64_t* out, std::uint64_t* changes, std::size_t words, const LifeKernelRule& rule)
+{
+    if (rule.conway)
+    {
+        return computeBlocks<true>(up, mid, down, out, changes, words, rule);
+    }
+    return computeBlocks<false>(up, mid, down, out, changes, words, rule);
+}
+
+std::uint32_t lifeTileMeasureAvx2Block(const std::uint64_t* cells, std::size_t stride, std::size_t rows, std::uint64_t* columns, std::uint64_t& liveRows)
+{
+    // Bytes are counted with a nibble lookup table and summed into the four 64-bit lanes every row
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0f);
+    const __m256i nibbleCounts = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i counts = zero;
+    __m256i columnBits = zero;
+    std::uint64_t live = 0;
+
+    for (std::size_t y = 0; y < rows; y++)
+    {
+        __m256i row = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cells + y * stride));
+        columnBits = _mm256_or_si256(columnBits, row);
+        live |= static_cast<std::uint64_t>(!_mm256_testz_si256(row, row)) << y;
+
+        __m256i low = _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(row, lowNibbles));
+        __m256i high = _mm256_shuffle_epi8(nibbleCounts, _mm256_and_si256(_mm256_srli_epi16(row, 4), lowNibbles));
+        counts = _mm256_add_epi64(counts, _mm256_sad_epu8(_mm256_add_epi8(low, high), zero));
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(columns), columnBits);
+    liveRows = live;
+    __m128i pairs = _mm_add_epi64(_mm256_castsi256_si128(counts), _mm256_extracti128_si256(counts, 1));
+    return static_cast<std::uint32_t>(_mm_cvtsi128_si64(pairs) + _mm_extract_epi64(pairs, 1));
+}
+#endif
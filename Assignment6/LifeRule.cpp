@@ -0,0 +1,163 @@
+#include "LifeRule.hpp"
+
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    const std::uint16_t CONWAY_BIRTH = 1 << 3;
+    const std::uint16_t CONWAY_SURVIVAL = (1 << 2) | (1 << 3);
+    const std::uint16_t ALL_COUNTS = (1 << 9) - 1;
+    // States are stored in one byte per cell
+    const std::uint32_t MAX_STATES = 255;
+
+    std::uint16_t parseCounts(const std::string& digits, const std::string& notation)
+    {
+        std::uint16_t counts = 0;
+        for (char digit : digits)
+        {
+            if (digit < '0' || digit > '8')
+            {
+                throw std::invalid_argument("Invalid neighbour count in rule \"" + notation + "\"");
+            }
+            counts |= static_cast<std::uint16_t>(1 << (digit - '0'));
+        }
+        return counts;
+    }
+
+    std::string countsToString(std::uint16_t counts)
+    {
+        std::string digits;
+        for (int count = 0; count <= 8; count++)
+        {
+            if ((counts >> count) & 1)
+            {
+                digits += static_cast<char>('0' + count);
+            }
+        }
+        return digits;
+    }
+}
+
+LifeRule::LifeRule() :
+    m_birthCounts(CONWAY_BIRTH),
+    m_survivalCounts(CONWAY_SURVIVAL)
+{
+}
+
+LifeRule::LifeRule(std::uint16_t birthCounts, std::uint16_t survivalCounts, std::uint32_t states) :
+    m_birthCounts(birthCounts & ALL_COUNTS),
+    m_survivalCounts(survivalCounts & ALL_COUNTS),
+    m_states(states)
+{
+    if (states < 2 || states > MAX_STATES)
+    {
+        throw std::invalid_argument("A rule needs between 2 and " + std::to_string(MAX_STATES) + " states");
+    }
+}
+
+LifeRule::LifeRule(const std::string& notation)
+{
+    auto slash = notation.find('/');
+    if (slash == std::string::npos)
+    {
+        throw std::invalid_argument("Rule \"" + notation + "\" must have two parts separated by '/'");
+    }
+
+    std::string first = notation.substr(0, slash);
+    std::string second = notation.substr(slash + 1);
+
+    // Generations rules end with the number of states, with or without a 'C'
+    auto stateSlash = second.find('/');
+    if (stateSlash != std::string::npos)
+    {
+        std::string states = second.substr(stateSlash + 1);
+        second = second.substr(0, stateSlash);
+        if (!states.empty() && std::toupper(static_cast<unsigned char>(states[0])) == 'C')
+        {
+            states = states.substr(1);
+        }
+        if (states.empty() || states.size() > 3 || states.find_first_not_of("0123456789") != std::string::npos)
+        {
+            throw std::invalid_argument("Invalid number of states in rule \"" + notation + "\"");
+        }
+        m_states = static_cast<std::uint32_t>(std::stoul(states));
+        if (m_states < 2 || m_states > MAX_STATES)
+        {
+            throw std::invalid_argument("Rule \"" + notation + "\" needs between 2 and " + std::to_string(MAX_STATES) + " states");
+        }
+    }
+    bool firstLabelled = !first.empty() && std::isalpha(static_cast<unsigned char>(first[0]));
+    bool secondLabelled = !second.empty() && std::isalpha(static_cast<unsigned char>(second[0]));
+
+    if (!firstLabelled && !secondLabelled)
+    {
+        // Survival-first notation without letters, such as "23/3"
+        m_survivalCounts = parseCounts(first, notation);
+        m_birthCounts = parseCounts(second, notation);
+        return;
+    }
+
+    char firstLabel = firstLabelled ? static_cast<char>(std::toupper(static_cast<unsigned char>(first[0]))) : '\0';
+    char secondLabel = secondLabelled ? static_cast<char>(std::toupper(static_cast<unsigned char>(second[0]))) : '\0';
+    if (firstLabel == 'B' && secondLabel == 'S')
+    {
+        m_birthCounts = parseCounts(first.substr(1), notation);
+        m_survivalCounts = parseCounts(second.substr(1), notation);
+    }
+    else if (firstLabel == 'S' && secondLabel == 'B')
+    {
+        m_survivalCounts = parseCounts(first.substr(1), notation);
+        m_birthCounts = parseCounts(second.substr(1), notation);
+    }
+    else
+    {
+        throw std::invalid_argument("Rule \"" + notation + "\" must have one B part and one S part");
+    }
+}
+
+std::uint16_t LifeRule::getBirthCounts() const
+{
+    return m_birthCounts;
+}
+
+std::uint16_t LifeRule::getSurvivalCounts() const
+{
+    return m_survivalCounts;
+}
+
+std::uint32_t LifeRule::getStates() const
+{
+    return m_states;
+}
+
+bool LifeRule::isBorn(int neighbours) const
+{
+    return (m_birthCounts >> neighbours) & 1;
+}
+
+bool LifeRule::survives(int neighbours) const
+{
+    return (m_survivalCounts >> neighbours) & 1;
+}
+
+std::string LifeRule::toString() const
+{
+    std::string notation = "B";
+    notation += countsToString(m_birthCounts);
+    notation += "/S";
+    notation += countsToString(m_survivalCounts);
+    if (m_states > 2)
+    {
+        notation += "/C";
+        notation += std::to_string(m_states);
+    }
+    return notation;
+}
+
+bool LifeRule::operator==(const LifeRule& other) const
+{
+    return m_birthCounts == other.m_birthCounts && m_survivalCounts == other.m_survivalCounts && m_states == other.m_states;
+}
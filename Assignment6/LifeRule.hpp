@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Outer-totalistic rule in B/S notation, such as "B3/S23" for Conway's Life or "B36/S23" for
+// HighLife. The older survival-first form "23/3" is accepted too.
+// A third part makes it a Generations rule with that many states, such as "B2/S/C3" (or "/2/3")
+// for Brian's Brain: a live cell that does not survive decays through states 2 to states - 1
+// before it is dead, and only live cells, state 1, count as neighbours.
+class LifeRule
+{
+  public:
+    // Conway's Life, B3/S23
+    LifeRule();
+    // Throws std::invalid_argument when the notation cannot be parsed
+    explicit LifeRule(const std::string& notation);
+    // Bit n of each mask is set when a cell with n live neighbours is born, or survives
+    // Throws std::invalid_argument unless states is between 2 and 255
+    LifeRule(std::uint16_t birthCounts, std::uint16_t survivalCounts, std::uint32_t states = 2);
+
+    std::uint16_t getBirthCounts() const;
+    std::uint16_t getSurvivalCounts() const;
+    // 2 for ordinary two-state rules
+    std::uint32_t getStates() const;
+
+    bool isBorn(int neighbours) const;
+    bool survives(int neighbours) const;
+    std::string toString() const;
+
+    bool operator==(const LifeRule& other) const;
+
+  private:
+    std::uint16_t m_birthCounts;
+    std::uint16_t m_survivalCounts;
+    std::uint32_t m_states = 2;
+};
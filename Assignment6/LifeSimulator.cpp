@@ -1,113 +1,871 @@
 #include "LifeSimulator.hpp"
 
+#include "LifeKernel.hpp"
 #include "Pattern.hpp"
+#include "PatternPacked.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-LifeSimulator::LifeSimulator(std::uint8_t sizeX, std::uint8_t sizeY)
+namespace
+{
+    const std::size_t BITS_PER_WORD = 64;
+    // A tile is one AVX2 block wide, 256 cells by 32 rows
+    const std::size_t TILE_WORDS = 4;
+    const std::size_t TILE_ROWS = 32;
+
+    const std::uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15;
+
+    // Final mix of splitmix64, so every input bit affects every output bit
+    std::uint64_t mixHash(std::uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+        return value ^ (value >> 31);
+    }
+}
+
+bool LifeBoundingBox::isEmpty() const
+{
+    return sizeX == 0 || sizeY == 0;
+}
+
+LifeBoundingBox LifeBoundingBox::unite(const LifeBoundingBox& other) const
+{
+    if (this->isEmpty())
+    {
+        return other;
+    }
+    if (other.isEmpty())
+    {
+        return *this;
+    }
+
+    std::uint32_t left = std::min(x, other.x);
+    std::uint32_t top = std::min(y, other.y);
+    std::uint32_t right = std::max(x + sizeX, other.x + other.sizeX);
+    std::uint32_t bottom = std::max(y + sizeY, other.y + other.sizeY);
+    return { left, top, right - left, bottom - top };
+}
+
+LifeSimulator::LifeSimulator(std::uint32_t sizeX, std::uint32_t sizeY, const LifeRule& rule) :
+    m_rule(rule),
+    m_kernelRule(rule.getBirthCounts(), rule.getSurvivalCounts())
 {
     m_sizeX = sizeX;
     m_sizeY = sizeY;
-    m_simGrid.resize(sizeX, std::vector<bool>(sizeY, false));
+    m_wordsPerRow = (sizeX + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    m_stride = m_wordsPerRow + 2;
+    m_lastWordMask = (sizeX % BITS_PER_WORD == 0) ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << (sizeX % BITS_PER_WORD)) - 1;
+    m_simGrid.resize((static_cast<std::size_t>(sizeY) + 2) * m_stride, 0);
+    m_nextGrid.resize(m_simGrid.size(), 0);
+    m_tilesX = (m_wordsPerRow + TILE_WORDS - 1) / TILE_WORDS;
+    m_tilesY = (sizeY + TILE_ROWS - 1) / TILE_ROWS;
+    // With B0 empty space comes alive, so every tile has to be computed the first time
+    m_tileChanged.resize(m_tilesX * m_tilesY, rule.isBorn(0) ? 1 : 0);
+    m_tileActive.resize(m_tileChanged.size(), 0);
+    m_tileRowChanges.resize(m_tilesY * m_wordsPerRow, 0);
+    m_tileUnmeasured.resize(m_tileChanged.size(), 0);
+    m_tilePopulation.resize(m_tileChanged.size(), 0);
+    m_tileBounds.resize(m_tileChanged.size());
+    m_tileRowPopulation.resize(m_tilesY, 0);
+    m_tileRowBounds.resize(m_tilesY);
+    m_tileHashes.resize(m_tileChanged.size(), 0);
+    m_tileRowHashes.resize(m_tilesY, 0);
+    m_hashHistory.resize(HASH_HISTORY, 0);
+    if (rule.getStates() > 2)
+    {
+        m_decaying.resize(m_wordsPerRow * sizeY, 0);
+        m_ages.resize(m_decaying.size() * BITS_PER_WORD, 0);
+    }
+    this->setKernel(detectLifeKernel());
 }
 
-std::uint8_t LifeSimulator::getSizeX() const
+void LifeSimulator::setBoundary(LifeBoundary boundary)
+{
+    if (boundary != m_boundary)
+    {
+        // Cells along the edges now see different neighbours
+        m_boundary = boundary;
+        this->markEdited(0, 0, m_sizeX, m_sizeY);
+    }
+}
+
+LifeBoundary LifeSimulator::getBoundary() const
+{
+    return m_boundary;
+}
+
+const LifeRule& LifeSimulator::getRule() const
+{
+    return m_rule;
+}
+
+std::uint64_t LifeSimulator::getGeneration() const
+{
+    return m_generation;
+}
+
+void LifeSimulator::setGeneration(std::uint64_t generation)
+{
+    m_generation = generation;
+}
+
+std::uint32_t LifeSimulator::getSizeX() const
 {
     return m_sizeX;
 }
 
-std::uint8_t LifeSimulator::getSizeY() const
+std::uint32_t LifeSimulator::getSizeY() const
 {
     return m_sizeY;
 }
 
-bool LifeSimulator::getCell(std::uint8_t x, std::uint8_t y) const
+bool LifeSimulator::getCell(std::uint32_t x, std::uint32_t y) const
 {
     if (((x >= this->getSizeX()) || (y >= this->getSizeY())))
     {
         return false;
     }
-    return m_simGrid[x][y];
+    return (m_simGrid[getWordIndex(x, y)] >> (x % BITS_PER_WORD)) & 1;
+}
+
+std::uint8_t LifeSimulator::getState(std::uint32_t x, std::uint32_t y) const
+{
+    if (this->getCell(x, y))
+    {
+        return 1;
+    }
+    if (m_ages.empty() || x >= this->getSizeX() || y >= this->getSizeY())
+    {
+        return 0;
+    }
+    return m_ages[static_cast<std::size_t>(y) * m_wordsPerRow * BITS_PER_WORD + x];
+}
+
+const std::uint64_t* LifeSimulator::getRow(std::uint32_t y) const
+{
+    return &m_simGrid[(static_cast<std::size_t>(y) + 1) * m_stride + 1];
+}
+
+std::size_t LifeSimulator::getWordsPerRow() const
+{
+    return m_wordsPerRow;
+}
+
+const std::uint64_t* LifeSimulator::getDecayingRow(std::uint32_t y) const
+{
+    return m_decaying.empty() ? nullptr : &m_decaying[static_cast<std::size_t>(y) * m_wordsPerRow];
+}
+
+const std::uint8_t* LifeSimulator::getAgeRow(std::uint32_t y) const
+{
+    return m_ages.empty() ? nullptr : &m_ages[static_cast<std::size_t>(y) * m_wordsPerRow * BITS_PER_WORD];
+}
+
+void LifeSimulator::setAgeRow(std::uint32_t y, const std::uint8_t* ages)
+{
+    if (m_ages.empty())
+    {
+        throw std::invalid_argument("Rule " + m_rule.toString() + " has no decaying states");
+    }
+    if (y >= this->getSizeY())
+    {
+        return;
+    }
+
+    std::uint8_t* rowAges = &m_ages[static_cast<std::size_t>(y) * m_wordsPerRow * BITS_PER_WORD];
+    for (std::uint32_t x = 0; x < this->getSizeX(); x++)
+    {
+        if (ages[x] == 1 || ages[x] >= m_rule.getStates())
+        {
+            throw std::invalid_argument("Rule " + m_rule.toString() + " has no state " + std::to_string(ages[x]));
+        }
+        rowAges[x] = this->getCell(x, y) ? 0 : ages[x];
+    }
+    for (std::size_t word = 0; word < m_wordsPerRow; word++)
+    {
+        std::uint64_t decaying = 0;
+        for (std::size_t bit = 0; bit < BITS_PER_WORD; bit++)
+        {
+            decaying |= static_cast<std::uint64_t>(rowAges[word * BITS_PER_WORD + bit] != 0) << bit;
+        }
+        m_decaying[y * m_wordsPerRow + word] = decaying;
+    }
+    // Decaying cells change every generation, so their tiles must be stepped again
+    this->markEdited(0, y, this->getSizeX(), 1);
+}
+
+void LifeSimulator::clear()
+{
+    std::fill(m_simGrid.begin(), m_simGrid.end(), 0);
+    std::fill(m_nextGrid.begin(), m_nextGrid.end(), 0);
+    std::fill(m_decaying.begin(), m_decaying.end(), 0);
+    std::fill(m_ages.begin(), m_ages.end(), 0);
+    std::fill(m_tileChanged.begin(), m_tileChanged.end(), m_rule.isBorn(0) ? 1 : 0);
+    std::fill(m_tileUnmeasured.begin(), m_tileUnmeasured.end(), 0);
+    std::fill(m_tilePopulation.begin(), m_tilePopulation.end(), 0);
+    std::fill(m_tileBounds.begin(), m_tileBounds.end(), LifeBoundingBox());
+    std::fill(m_tileRowPopulation.begin(), m_tileRowPopulation.end(), 0);
+    std::fill(m_tileRowBounds.begin(), m_tileRowBounds.end(), LifeBoundingBox());
+    m_population = 0;
+    m_boundingBox = LifeBoundingBox();
+    m_generation = 0;
+    this->forgetHistory();
 }
 
 void LifeSimulator::update()
 {
-    std::vector<std::vector<bool>> updated(this->getSizeX(), std::vector<bool>(this->getSizeY(), false));
+    this->step(1);
+}
+
+void LifeSimulator::step(std::size_t generations)
+{
+    if (m_wordsPerRow == 0)
+    {
+        return;
+    }
+
+    for (std::size_t generation = 0; generation < generations; generation++)
+    {
+        this->computeNextGeneration();
+        m_simGrid.swap(m_nextGrid);
+        m_generation++;
+        m_measured = false;
+        if (m_detectPeriods)
+        {
+            this->updateHash();
+            this->recordHash();
+        }
+    }
+}
+
+void LifeSimulator::setPeriodDetection(bool enabled)
+{
+    if (enabled && !m_detectPeriods)
+    {
+        m_detectPeriods = true;
+        this->rehashBoard();
+    }
+    m_detectPeriods = enabled;
+}
+
+bool LifeSimulator::getPeriodDetection() const
+{
+    return m_detectPeriods;
+}
+
+std::size_t LifeSimulator::stepUntilStable(std::size_t maxGenerations)
+{
+    this->setPeriodDetection(true);
+    for (std::size_t generation = 0; generation < maxGenerations; generation++)
+    {
+        if (this->isStable())
+        {
+            return generation;
+        }
+        this->step(1);
+    }
+    return maxGenerations;
+}
+
+std::uint64_t LifeSimulator::getHash() const
+{
+    return m_hash;
+}
+
+std::size_t LifeSimulator::detectedPeriod() const
+{
+    return m_period;
+}
+
+bool LifeSimulator::isStable() const
+{
+    return m_period != 0;
+}
+
+void LifeSimulator::setThreadCount(std::size_t threadCount)
+{
+    if (threadCount <= 1)
+    {
+        m_threadPool.reset();
+    }
+    else if (threadCount != this->getThreadCount())
+    {
+        m_threadPool = std::make_unique<ThreadPool>(threadCount);
+    }
+}
+
+std::size_t LifeSimulator::getThreadCount() const
+{
+    return m_threadPool ? m_threadPool->getThreadCount() : 1;
+}
+
+void LifeSimulator::setKernel(LifeKernelType kernel)
+{
+    m_kernel = isLifeKernelSupported(kernel) ? kernel : LifeKernelType::Scalar;
+    m_rowKernel = getLifeRowKernel(m_kernel, m_kernelRule);
+    m_measureTile = getLifeTileMeasure(m_kernel);
+    m_decayKernel = getLifeDecayKernel(m_kernel);
+}
+
+LifeKernelType LifeSimulator::getKernel() const
+{
+    return m_kernel;
+}
+
+std::uint64_t LifeSimulator::population() const
+{
+    this->measureChangedTiles();
+    return m_population;
+}
+
+LifeBoundingBox LifeSimulator::boundingBox() const
+{
+    this->measureChangedTiles();
+    return m_boundingBox;
+}
+
+std::size_t LifeSimulator::getActiveTileCount() const
+{
+    return m_activeTiles;
+}
+
+std::uint64_t LifeSimulator::getActiveCellCount() const
+{
+    return m_activeCells;
+}
+
+void LifeSimulator::computeNextGeneration()
+{
+    // The boundary is dispatched once per generation: the guard cells are filled for it up front,
+    // so the row kernels run over the whole board with no edge tests
+    switch (m_boundary)
+    {
+        case LifeBoundary::Torus:
+            this->fillGuards<LifeBoundary::Torus>(m_simGrid);
+            this->markActiveTiles<LifeBoundary::Torus>();
+            break;
+        case LifeBoundary::Mirror:
+            this->fillGuards<LifeBoundary::Mirror>(m_simGrid);
+            this->markActiveTiles<LifeBoundary::Mirror>();
+            break;
+        default:
+            this->markActiveTiles<LifeBoundary::Dead>();
+            break;
+    }
+
+    if (!m_threadPool)
+    {
+        this->computeTileRows(0, m_tilesY);
+    }
+    else
+    {
+        // Each band only writes its own rows of the back buffer and reads the rows bordering it
+        // straight from the front buffer, so no halo needs to be copied between bands
+        m_threadPool->parallelFor(m_tilesY, [this](std::size_t beginTileRow, std::size_t endTileRow)
+                                  {
+                                      this->computeTileRows(beginTileRow, endTileRow);
+                                  });
+    }
+
+    if (m_boundary != LifeBoundary::Dead)
+    {
+        this->clearGuards(m_simGrid);
+    }
+}
+
+template <LifeBoundary Boundary>
+void LifeSimulator::fillGuards(std::vector<std::uint64_t>& grid)
+{
+    std::size_t lastBit = (m_sizeX - 1) % BITS_PER_WORD;
+    std::size_t pastBit = m_sizeX % BITS_PER_WORD;
+
+    for (std::size_t y = 1; y <= m_sizeY; y++)
+    {
+        std::uint64_t* row = &grid[y * m_stride + 1];
+        std::uint64_t first = row[0] & 1;
+        std::uint64_t last = (row[m_wordsPerRow - 1] >> lastBit) & 1;
+        std::uint64_t left = (Boundary == LifeBoundary::Torus) ? last : first;
+        std::uint64_t right = (Boundary == LifeBoundary::Torus) ? first : last;
+
+        row[-1] = left << (BITS_PER_WORD - 1);
+        // When the board ends inside a word, the cell past the right edge is the next bit of that
+        // word; clearGuards takes it out again once the generation is computed
+        if (pastBit == 0)
+        {
+            row[m_wordsPerRow] = right;
+        }
+        else
+        {
+            row[m_wordsPerRow - 1] |= right << pastBit;
+        }
+    }
+
+    // Whole rows are copied, guard words included, so the corners come out right as well
+    std::size_t top = (Boundary == LifeBoundary::Torus) ? m_sizeY : 1;
+    std::size_t bottom = (Boundary == LifeBoundary::Torus) ? 1 : m_sizeY;
+    std::copy(grid.begin() + top * m_stride, grid.begin() + (top + 1) * m_stride, grid.begin());
+    std::copy(grid.begin() + bottom * m_stride, grid.begin() + (bottom + 1) * m_stride, grid.begin() + (m_sizeY + 1) * m_stride);
+}
+
+void LifeSimulator::clearGuards(std::vector<std::uint64_t>& grid)
+{
+    std::fill(grid.begin(), grid.begin() + m_stride, 0);
+    std::fill(grid.end() - m_stride, grid.end(), 0);
+    for (std::size_t y = 1; y <= m_sizeY; y++)
+    {
+        std::uint64_t* row = &grid[y * m_stride];
+        row[0] = 0;
+        row[m_wordsPerRow] &= m_lastWordMask;
+        row[m_wordsPerRow + 1] = 0;
+    }
+}
+
+template <LifeBoundary Boundary>
+void LifeSimulator::markActiveTiles()
+{
+    m_activeTiles = 0;
+    m_activeCells = 0;
+    // On a torus the tiles along opposite edges are neighbours
+    bool wrap = Boundary == LifeBoundary::Torus;
 
-    for (std::uint8_t i = 0; i < m_simGrid.size(); i++)
+    for (std::size_t tileY = 0; tileY < m_tilesY; tileY++)
     {
-        for (std::uint8_t j = 0; j < m_simGrid[i].size(); j++)
+        std::size_t aboveY = tileY > 0 ? tileY - 1 : (wrap ? m_tilesY - 1 : tileY);
+        std::size_t belowY = tileY + 1 < m_tilesY ? tileY + 1 : (wrap ? 0 : tileY);
+        // Tiles along the right and bottom edges may hang over the board
+        std::uint64_t tileRows = std::min(TILE_ROWS, m_sizeY - tileY * TILE_ROWS);
+
+        for (std::size_t tileX = 0; tileX < m_tilesX; tileX++)
         {
-            std::uint8_t count = this->getNeighbor(i, j);
+            std::size_t leftX = tileX > 0 ? tileX - 1 : (wrap ? m_tilesX - 1 : tileX);
+            std::size_t rightX = tileX + 1 < m_tilesX ? tileX + 1 : (wrap ? 0 : tileX);
+            std::uint8_t active = 0;
 
-            if (this->getCell(i, j))
+            for (std::size_t y : { aboveY, tileY, belowY })
             {
-                updated[i][j] = count >= 2 && count <= 3;
+                for (std::size_t x : { leftX, tileX, rightX })
+                {
+                    active |= m_tileChanged[y * m_tilesX + x];
+                }
             }
-            else if (!this->getCell(i, j) && count == 3)
+            m_tileActive[tileY * m_tilesX + tileX] = active;
+            m_activeTiles += active;
+            if (active)
             {
-                updated[i][j] = true;
+                m_activeCells += std::min(TILE_WORDS * BITS_PER_WORD, m_sizeX - tileX * TILE_WORDS * BITS_PER_WORD) * tileRows;
             }
         }
     }
-    m_simGrid = updated;
 }
 
-void LifeSimulator::insertPattern(const Pattern& pattern, std::uint8_t startX, std::uint8_t startY)
+void LifeSimulator::computeTileRows(std::size_t beginTileRow, std::size_t endTileRow)
 {
-    for (std::uint8_t i = 0; i < pattern.getSizeX(); i++)
+    for (std::size_t tileY = beginTileRow; tileY < endTileRow; tileY++)
     {
-        for (std::uint8_t j = 0; j < pattern.getSizeY(); j++)
+        const std::uint8_t* active = &m_tileActive[tileY * m_tilesX];
+        std::size_t tileX = 0;
+
+        // Neighbouring active tiles are computed together so the kernel sees long runs of words
+        while (tileX < m_tilesX)
         {
-            if ((this->getSizeX() > (startX + i)) && (this->getSizeY() > (startY + j)))
+            if (!active[tileX])
+            {
+                m_tileChanged[tileY * m_tilesX + tileX] = 0;
+                tileX++;
+                continue;
+            }
+
+            std::size_t endTileX = tileX + 1;
+            while (endTileX < m_tilesX && active[endTileX])
             {
-                this->setSquare(((startX + i)), ((startY + j)), pattern.getCell(i, j));
+                endTileX++;
             }
+            this->computeTileRun(tileY, tileX, endTileX);
+            tileX = endTileX;
         }
     }
 }
 
-void LifeSimulator::setSquare(std::uint8_t x, std::uint8_t y, bool value)
+void LifeSimulator::computeTileRun(std::size_t tileY, std::size_t beginTileX, std::size_t endTileX)
 {
-    this->m_simGrid[x][y] = value;
+    std::size_t firstWord = beginTileX * TILE_WORDS;
+    std::size_t endWord = std::min(endTileX * TILE_WORDS, m_wordsPerRow);
+    std::size_t endRow = std::min((tileY + 1) * TILE_ROWS, static_cast<std::size_t>(m_sizeY));
+    std::uint64_t* changes = &m_tileRowChanges[tileY * m_wordsPerRow];
+
+    std::fill(changes + firstWord, changes + endWord, 0);
+
+    // Only the board words are written; the guard words and rows of both buffers stay dead
+    for (std::size_t y = tileY * TILE_ROWS + 1; y <= endRow; y++)
+    {
+        const std::uint64_t* mid = &m_simGrid[y * m_stride + 1];
+        std::uint64_t* out = &m_nextGrid[y * m_stride + 1];
+
+        m_rowKernel(mid - m_stride + firstWord, mid + firstWord, mid + m_stride + firstWord, out + firstWord, changes + firstWord, endWord - firstWord, m_kernelRule);
+        if (endWord == m_wordsPerRow)
+        {
+            // Cells past the right edge of the board must stay dead
+            out[endWord - 1] &= m_lastWordMask;
+        }
+
+        if (!m_decaying.empty())
+        {
+            std::size_t index = (y - 1) * m_wordsPerRow + firstWord;
+            m_decayKernel(mid + firstWord, out + firstWord, changes + firstWord, &m_decaying[index], &m_ages[index * BITS_PER_WORD], endWord - firstWord, static_cast<std::uint8_t>(m_rule.getStates()));
+            if (endWord == m_wordsPerRow && m_lastWordMask != ~std::uint64_t{ 0 })
+            {
+                // A wrapped or mirrored guard cell past the edge looks like a cell that just died
+                std::size_t rowEnd = (index - firstWord + m_wordsPerRow) * BITS_PER_WORD;
+                std::fill(m_ages.begin() + (rowEnd - BITS_PER_WORD + m_sizeX % BITS_PER_WORD), m_ages.begin() + rowEnd, 0);
+                m_decaying[index - firstWord + m_wordsPerRow - 1] &= m_lastWordMask;
+            }
+        }
+    }
+
+    if (endWord == m_wordsPerRow)
+    {
+        changes[endWord - 1] &= m_lastWordMask;
+    }
+    for (std::size_t tileX = beginTileX; tileX < endTileX; tileX++)
+    {
+        std::uint64_t difference = 0;
+        for (std::size_t word = tileX * TILE_WORDS; word < std::min((tileX + 1) * TILE_WORDS, endWord); word++)
+        {
+            difference |= changes[word];
+        }
+        m_tileChanged[tileY * m_tilesX + tileX] = difference != 0;
+        if (difference == 0)
+        {
+            continue;
+        }
+        m_tileUnmeasured[tileY * m_tilesX + tileX] = 1;
+        if (m_detectPeriods)
+        {
+            this->rehashTile(tileX, tileY, m_nextGrid);
+        }
+    }
 }
 
-std::uint8_t LifeSimulator::getNeighbor(std::uint8_t x, std::uint8_t y)
+void LifeSimulator::insertPattern(const Pattern& pattern, std::uint32_t startX, std::uint32_t startY)
 {
-    std::uint8_t count = 0;
+    if (startX >= this->getSizeX() || startY >= this->getSizeY())
+    {
+        return;
+    }
+
+    // Clip the pattern to the board up front so the coordinates below can never overflow
+    std::uint32_t sizeX = std::min(pattern.getSizeX(), this->getSizeX() - startX);
+    std::uint32_t sizeY = std::min(pattern.getSizeY(), this->getSizeY() - startY);
+
+    for (std::uint32_t i = 0; i < sizeX; i++)
+    {
+        for (std::uint32_t j = 0; j < sizeY; j++)
+        {
+            this->setSquare(startX + i, startY + j, pattern.getCell(i, j));
+        }
+    }
+    this->clearDecay(startX, startY, sizeX, sizeY);
+    this->markEdited(startX, startY, sizeX, sizeY);
+}
 
-    if (this->getCell(x + 1, y + 1))
+void LifeSimulator::insertPattern(const PatternPacked& pattern, std::uint32_t startX, std::uint32_t startY)
+{
+    if (startX >= this->getSizeX() || startY >= this->getSizeY())
     {
-        count++;
+        return;
     }
-    if (this->getCell(x + 1, y - 1))
+
+    std::uint32_t sizeX = std::min(pattern.getSizeX(), this->getSizeX() - startX);
+    std::uint32_t sizeY = std::min(pattern.getSizeY(), this->getSizeY() - startY);
+    if (sizeX == 0 || sizeY == 0)
     {
-        count++;
+        return;
     }
-    if (this->getCell(x - 1, y + 1))
+
+    // Each source word lands across two board words; the bits beyond the first spill into the
+    // next one, which is at worst the right guard word and then only receives zeros
+    std::size_t firstWord = startX / BITS_PER_WORD;
+    std::size_t shift = startX % BITS_PER_WORD;
+    for (std::uint32_t y = 0; y < sizeY; y++)
     {
-        count++;
+        const std::uint64_t* source = pattern.getRow(y);
+        std::uint64_t* row = &m_simGrid[(static_cast<std::size_t>(startY) + y + 1) * m_stride + 1 + firstWord];
+
+        for (std::uint32_t x = 0; x < sizeX; x += BITS_PER_WORD)
+        {
+            std::uint32_t count = std::min<std::uint32_t>(BITS_PER_WORD, sizeX - x);
+            std::uint64_t mask = (count == BITS_PER_WORD) ? ~std::uint64_t{ 0 } : (std::uint64_t{ 1 } << count) - 1;
+            std::uint64_t bits = source[x / BITS_PER_WORD] & mask;
+            std::uint64_t* target = row + x / BITS_PER_WORD;
+
+            target[0] = (target[0] & ~(mask << shift)) | (bits << shift);
+            if (shift != 0)
+            {
+                target[1] = (target[1] & ~(mask >> (BITS_PER_WORD - shift))) | (bits >> (BITS_PER_WORD - shift));
+            }
+        }
     }
-    if (this->getCell(x - 1, y - 1))
+
+    this->clearDecay(startX, startY, sizeX, sizeY);
+    this->markEdited(startX, startY, sizeX, sizeY);
+}
+
+void LifeSimulator::clearDecay(std::uint32_t startX, std::uint32_t startY, std::uint32_t sizeX, std::uint32_t sizeY)
+{
+    if (m_decaying.empty() || sizeX == 0)
     {
-        count++;
+        return;
     }
-    if (this->getCell(x + 1, y))
+
+    // Inserted cells replace whatever was decaying underneath them
+    std::size_t firstWord = startX / BITS_PER_WORD;
+    std::size_t endWord = (static_cast<std::size_t>(startX) + sizeX - 1) / BITS_PER_WORD + 1;
+    for (std::size_t y = startY; y < static_cast<std::size_t>(startY) + sizeY; y++)
     {
-        count++;
+        std::uint8_t* rowAges = &m_ages[y * m_wordsPerRow * BITS_PER_WORD];
+        std::fill(rowAges + startX, rowAges + startX + sizeX, 0);
+        for (std::size_t word = firstWord; word < endWord; word++)
+        {
+            std::uint64_t decaying = 0;
+            for (std::size_t bit = 0; bit < BITS_PER_WORD; bit++)
+            {
+                decaying |= static_cast<std::uint64_t>(rowAges[word * BITS_PER_WORD + bit] != 0) << bit;
+            }
+            m_decaying[y * m_wordsPerRow + word] = decaying;
+        }
     }
-    if (this->getCell(x - 1, y))
+}
+
+void LifeSimulator::setSquare(std::uint32_t x, std::uint32_t y, bool value)
+{
+    std::uint64_t bit = std::uint64_t{ 1 } << (x % BITS_PER_WORD);
+    std::uint64_t& word = m_simGrid[getWordIndex(x, y)];
+
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+void LifeSimulator::markEdited(std::uint32_t startX, std::uint32_t startY, std::uint32_t sizeX, std::uint32_t sizeY)
+{
+    if (sizeX == 0 || sizeY == 0)
     {
-        count++;
+        return;
     }
-    if (this->getCell(x, y + 1))
+
+    std::size_t beginTileX = (startX / BITS_PER_WORD) / TILE_WORDS;
+    std::size_t endTileX = ((static_cast<std::size_t>(startX) + sizeX - 1) / BITS_PER_WORD) / TILE_WORDS + 1;
+    std::size_t beginTileY = startY / TILE_ROWS;
+    std::size_t endTileY = (static_cast<std::size_t>(startY) + sizeY - 1) / TILE_ROWS + 1;
+
+    for (std::size_t tileY = beginTileY; tileY < endTileY; tileY++)
     {
-        count++;
+        for (std::size_t tileX = beginTileX; tileX < endTileX; tileX++)
+        {
+            m_tileChanged[tileY * m_tilesX + tileX] = 1;
+            m_tileUnmeasured[tileY * m_tilesX + tileX] = 1;
+        }
     }
-    if (this->getCell(x, y - 1))
+    m_measured = false;
+    // The earlier generations no longer lead to this board
+    this->forgetHistory();
+}
+
+void LifeSimulator::measureChangedTiles() const
+{
+    if (m_measured)
     {
-        count++;
+        return;
     }
+    m_measured = true;
 
-    return count;
+    bool changed = false;
+    for (std::size_t tileY = 0; tileY < m_tilesY; tileY++)
+    {
+        bool rowChanged = false;
+        for (std::size_t tileX = 0; tileX < m_tilesX; tileX++)
+        {
+            if (m_tileUnmeasured[tileY * m_tilesX + tileX])
+            {
+                m_tileUnmeasured[tileY * m_tilesX + tileX] = 0;
+                this->measureTile(tileX, tileY);
+                rowChanged = true;
+            }
+        }
+        if (rowChanged)
+        {
+            this->summarizeTileRow(tileY);
+            changed = true;
+        }
+    }
+
+    if (changed)
+    {
+        this->summarizeBoard();
+    }
+}
+
+void LifeSimulator::measureTile(std::size_t tileX, std::size_t tileY) const
+{
+    std::size_t firstWord = tileX * TILE_WORDS;
+    std::size_t words = std::min(TILE_WORDS, m_wordsPerRow - firstWord);
+    std::size_t beginRow = tileY * TILE_ROWS;
+    std::size_t endRow = std::min(beginRow + TILE_ROWS, static_cast<std::size_t>(m_sizeY));
+
+    std::uint64_t columns[TILE_WORDS];
+    std::uint64_t liveRows;
+    std::uint32_t population = m_measureTile(&m_simGrid[(beginRow + 1) * m_stride + 1 + firstWord], m_stride, words, endRow - beginRow, columns, liveRows);
+
+    LifeBoundingBox bounds;
+    if (population != 0)
+    {
+        std::size_t first = 0;
+        while (columns[first] == 0)
+        {
+            first++;
+        }
+        std::size_t last = words - 1;
+        while (columns[last] == 0)
+        {
+            last--;
+        }
+        std::size_t left = (firstWord + first) * BITS_PER_WORD + std::countr_zero(columns[first]);
+        std::size_t right = (firstWord + last) * BITS_PER_WORD + BITS_PER_WORD - std::countl_zero(columns[last]);
+        std::size_t top = beginRow + std::countr_zero(liveRows);
+        std::size_t bottom = beginRow + BITS_PER_WORD - std::countl_zero(liveRows);
+        bounds = { static_cast<std::uint32_t>(left), static_cast<std::uint32_t>(top), static_cast<std::uint32_t>(right - left), static_cast<std::uint32_t>(bottom - top) };
+    }
+
+    m_tilePopulation[tileY * m_tilesX + tileX] = population;
+    m_tileBounds[tileY * m_tilesX + tileX] = bounds;
+}
+
+void LifeSimulator::summarizeTileRow(std::size_t tileY) const
+{
+    std::uint64_t population = 0;
+    LifeBoundingBox bounds;
+    for (std::size_t tile = tileY * m_tilesX; tile < (tileY + 1) * m_tilesX; tile++)
+    {
+        population += m_tilePopulation[tile];
+        bounds = bounds.unite(m_tileBounds[tile]);
+    }
+    m_tileRowPopulation[tileY] = population;
+    m_tileRowBounds[tileY] = bounds;
+}
+
+void LifeSimulator::summarizeBoard() const
+{
+    m_population = 0;
+    m_boundingBox = LifeBoundingBox();
+    for (std::size_t tileY = 0; tileY < m_tilesY; tileY++)
+    {
+        m_population += m_tileRowPopulation[tileY];
+        m_boundingBox = m_boundingBox.unite(m_tileRowBounds[tileY]);
+    }
+}
+
+void LifeSimulator::rehashBoard()
+{
+    for (std::size_t tileY = 0; tileY < m_tilesY; tileY++)
+    {
+        for (std::size_t tileX = 0; tileX < m_tilesX; tileX++)
+        {
+            this->rehashTile(tileX, tileY, m_simGrid);
+        }
+    }
+    this->updateHash();
+
+    m_historyCount = 0;
+    this->recordHash();
+}
+
+void LifeSimulator::forgetHistory()
+{
+    // A period found before detection was turned off must not survive an edit either
+    m_period = 0;
+    m_historyNext = 0;
+    m_historyCount = 0;
+    if (m_detectPeriods)
+    {
+        this->rehashBoard();
+    }
+}
+
+void LifeSimulator::rehashTile(std::size_t tileX, std::size_t tileY, const std::vector<std::uint64_t>& grid)
+{
+    std::size_t firstWord = tileX * TILE_WORDS;
+    std::size_t words = std::min(TILE_WORDS, m_wordsPerRow - firstWord);
+    std::size_t endRow = std::min((tileY + 1) * TILE_ROWS, static_cast<std::size_t>(m_sizeY));
+
+    // Separate lanes for each word column of odd and even rows keep the multiplies independent
+    std::uint64_t lanes[TILE_WORDS * 2] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    for (std::size_t y = tileY * TILE_ROWS + 1; y <= endRow; y++)
+    {
+        const std::uint64_t* row = &grid[y * m_stride + 1 + firstWord];
+        std::uint64_t* rowLanes = &lanes[(y % 2) * TILE_WORDS];
+        for (std::size_t word = 0; word < words; word++)
+        {
+            rowLanes[word] = std::rotl((rowLanes[word] ^ row[word]) * HASH_MULTIPLIER, 31);
+        }
+
+        // Under Generations rules the board repeats only when the decaying states do as well
+        if (!m_ages.empty())
+        {
+            const std::uint8_t* rowAges = &m_ages[((y - 1) * m_wordsPerRow + firstWord) * BITS_PER_WORD];
+            for (std::size_t chunk = 0; chunk < words * 8; chunk++)
+            {
+                std::uint64_t ages;
+                std::memcpy(&ages, rowAges + chunk * 8, sizeof(ages));
+                rowLanes[chunk / 8] = std::rotl((rowLanes[chunk / 8] ^ ages) * HASH_MULTIPLIER, 31);
+            }
+        }
+    }
+
+    // Mix in the position so identical tiles in different places do not cancel out
+    std::size_t tile = tileY * m_tilesX + tileX;
+    std::uint64_t hash = tile;
+    for (auto lane : lanes)
+    {
+        hash = mixHash(hash ^ lane);
+    }
+
+    m_tileRowHashes[tileY] ^= m_tileHashes[tile] ^ hash;
+    m_tileHashes[tile] = hash;
+}
+
+void LifeSimulator::updateHash()
+{
+    m_hash = 0;
+    for (auto rowHash : m_tileRowHashes)
+    {
+        m_hash ^= rowHash;
+    }
+}
+
+void LifeSimulator::recordHash()
+{
+    // Look for this board among the previous generations, most recent first
+    m_period = 0;
+    for (std::size_t age = 1; age <= m_historyCount; age++)
+    {
+        if (m_hashHistory[(m_historyNext + HASH_HISTORY - age) % HASH_HISTORY] == m_hash)
+        {
+            m_period = age;
+            break;
+        }
+    }
+
+    m_hashHistory[m_historyNext] = m_hash;
+    m_historyNext = (m_historyNext + 1) % HASH_HISTORY;
+    m_historyCount = std::min(m_historyCount + 1, HASH_HISTORY);
+}
+
+std::size_t LifeSimulator::getWordIndex(std::uint32_t x, std::uint32_t y) const
+{
+    return (static_cast<std::size_t>(y) + 1) * m_stride + 1 + x / BITS_PER_WORD;
 }
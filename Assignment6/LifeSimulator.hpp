@@ -1,25 +1,182 @@
 #pragma once
+#include "LifeBoundary.hpp"
+#include "LifeKernel.hpp"
+#include "LifeRule.hpp"
 #include "Pattern.hpp"
+#include "PatternPacked.hpp"
+#include "ThreadPool.hpp"
 
+#include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+// Smallest rectangle holding every live cell; sizeX and sizeY are 0 when there are none
+class LifeBoundingBox
+{
+  public:
+    std::uint32_t x = 0;
+    std::uint32_t y = 0;
+    std::uint32_t sizeX = 0;
+    std::uint32_t sizeY = 0;
+
+    bool isEmpty() const;
+    // Smallest box holding both
+    LifeBoundingBox unite(const LifeBoundingBox& other) const;
+    bool operator==(const LifeBoundingBox& other) const = default;
+};
+
 class LifeSimulator
 {
   public:
-    LifeSimulator(std::uint8_t sizeX, std::uint8_t sizeY);
+    LifeSimulator(std::uint32_t sizeX, std::uint32_t sizeY, const LifeRule& rule = LifeRule());
 
-    void insertPattern(const Pattern& pattern, std::uint8_t startX, std::uint8_t startY);
+    void insertPattern(const Pattern& pattern, std::uint32_t startX, std::uint32_t startY);
+    // Copies packed patterns a row at a time rather than a cell at a time
+    void insertPattern(const PatternPacked& pattern, std::uint32_t startX, std::uint32_t startY);
+    // Kills every cell and sets the generation back to 0, keeping the buffers, rule, kernel and threads
+    void clear();
     void update();
+    void step(std::size_t generations);
+    // Period detection keeps a 64-bit hash of the board, updated from the tiles that change each
+    // generation, and the hashes of the last HASH_HISTORY generations. Hashing costs up to a
+    // third of the throughput on dense boards, so it is off until enabled.
+    void setPeriodDetection(bool enabled);
+    bool getPeriodDetection() const;
+    // Turns on period detection and steps until a repeat is seen or maxGenerations have run;
+    // returns the generations run
+    std::size_t stepUntilStable(std::size_t maxGenerations);
+
+    std::uint64_t getHash() const;
+    // Generations between repeats of the current board; 1 for a still life and 0 until a repeat
+    // is seen. Inserting a pattern forgets the history.
+    std::size_t detectedPeriod() const;
+    bool isStable() const;
+
+    // Steps the board in row bands on a persistent pool of this many threads; 1 runs serially
+    void setThreadCount(std::size_t threadCount);
+    std::size_t getThreadCount() const;
+
+    // Defaults to the widest kernel the CPU supports; unsupported choices fall back to Scalar
+    void setKernel(LifeKernelType kernel);
+    LifeKernelType getKernel() const;
 
-    std::uint8_t getSizeX() const;
-    std::uint8_t getSizeY() const;
-    bool getCell(std::uint8_t x, std::uint8_t y) const;
+    // Dead by default. The board itself is stepped by the same kernels whatever the boundary;
+    // only the guard cells around it are filled differently before each generation.
+    void setBoundary(LifeBoundary boundary);
+    LifeBoundary getBoundary() const;
+
+    const LifeRule& getRule() const;
+    // Counts the generations stepped; restoring a checkpoint sets it back to the saved value
+    std::uint64_t getGeneration() const;
+    void setGeneration(std::uint64_t generation);
+    std::uint32_t getSizeX() const;
+    std::uint32_t getSizeY() const;
+    bool getCell(std::uint32_t x, std::uint32_t y) const;
+    // 0 for dead cells, 1 for live ones and, under Generations rules, 2 up to the rule's states - 1
+    // for decaying cells. getCell is true for state 1 only.
+    std::uint8_t getState(std::uint32_t x, std::uint32_t y) const;
+
+    // Row y packed 64 cells per word, cell x in bit x % 64 of word x / 64; bits past the edge are dead
+    const std::uint64_t* getRow(std::uint32_t y) const;
+    std::size_t getWordsPerRow() const;
+    // Row y packed like getRow, with the decaying cells set; nullptr unless the rule is a Generations rule
+    const std::uint64_t* getDecayingRow(std::uint32_t y) const;
+    // Row y of states, a byte for each of the getWordsPerRow() * 64 cells, 0 for cells that are not
+    // decaying; nullptr unless the rule is a Generations rule
+    const std::uint8_t* getAgeRow(std::uint32_t y) const;
+    // Restores row y of decaying states from bytes laid out like getAgeRow, as when resuming a
+    // checkpoint. Live cells and cells past the edge stay as they are. Throws std::invalid_argument
+    // for two-state rules and for states the rule does not have.
+    void setAgeRow(std::uint32_t y, const std::uint8_t* ages);
+
+    // Live cells, in state 1, and the box around them. Each tile keeps its own count and extents, and only the
+    // tiles that changed since the last call are measured again, so stepping pays nothing for
+    // them and asking again without stepping is O(1).
+    std::uint64_t population() const;
+    LifeBoundingBox boundingBox() const;
+
+    // Number of tiles that were recomputed by the last generation
+    std::size_t getActiveTileCount() const;
+    // Board cells in those tiles, which is the work the last generation actually did
+    std::uint64_t getActiveCellCount() const;
+
+    static constexpr std::size_t HASH_HISTORY = 64;
 
   private:
-    std::uint8_t m_sizeX;
-    std::uint8_t m_sizeY;
-    std::vector<std::vector<bool>> m_simGrid;
-    void setSquare(std::uint8_t x, std::uint8_t y, bool value);
-    std::uint8_t getNeighbor(std::uint8_t x, std::uint8_t y);
-};
\ No newline at end of file
+    std::uint32_t m_sizeX;
+    std::uint32_t m_sizeY;
+    std::uint64_t m_generation = 0;
+    // Rows are packed 64 cells per word with one dead guard word on each side and one
+    // dead guard row above and below, so the neighbourhood of every cell is always in memory
+    std::size_t m_wordsPerRow;
+    std::size_t m_stride;
+    std::uint64_t m_lastWordMask;
+    // The next generation is written into m_nextGrid and the two are swapped, so stepping never allocates
+    std::vector<std::uint64_t> m_simGrid;
+    std::vector<std::uint64_t> m_nextGrid;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    LifeRule m_rule;
+    LifeKernelRule m_kernelRule;
+    LifeKernelType m_kernel;
+    LifeBoundary m_boundary = LifeBoundary::Dead;
+    LifeRowKernel m_rowKernel;
+    LifeTileMeasure m_measureTile;
+    LifeDecayKernel m_decayKernel;
+    // Only used by Generations rules: a bit per decaying cell, packed like the rows without guard
+    // words, and a byte per cell for its state. Decaying cells are never anyone's neighbour, so
+    // these are updated in place instead of being double buffered.
+    std::vector<std::uint64_t> m_decaying;
+    std::vector<std::uint8_t> m_ages;
+    // The board is split into tiles and only tiles that changed last generation, or border one
+    // that did, are recomputed. A tile that did not change holds the same cells in both buffers.
+    std::size_t m_tilesX;
+    std::size_t m_tilesY;
+    std::vector<std::uint8_t> m_tileChanged;
+    std::vector<std::uint8_t> m_tileActive;
+    // Bits the kernel changed in each word column, one row of words per row of tiles
+    std::vector<std::uint64_t> m_tileRowChanges;
+    std::size_t m_activeTiles = 0;
+    std::uint64_t m_activeCells = 0;
+    // Live cells and extents of each tile and each row of tiles, brought up to date when read
+    mutable std::vector<std::uint8_t> m_tileUnmeasured;
+    mutable std::vector<std::uint32_t> m_tilePopulation;
+    mutable std::vector<LifeBoundingBox> m_tileBounds;
+    mutable std::vector<std::uint64_t> m_tileRowPopulation;
+    mutable std::vector<LifeBoundingBox> m_tileRowBounds;
+    mutable std::uint64_t m_population = 0;
+    mutable LifeBoundingBox m_boundingBox;
+    mutable bool m_measured = true;
+    bool m_detectPeriods = false;
+    // Each tile row keeps the XOR of its tile hashes, so threads only touch their own rows
+    std::vector<std::uint64_t> m_tileHashes;
+    std::vector<std::uint64_t> m_tileRowHashes;
+    std::uint64_t m_hash = 0;
+    // Ring buffer of the hashes of the last HASH_HISTORY generations
+    std::vector<std::uint64_t> m_hashHistory;
+    std::size_t m_historyNext = 0;
+    std::size_t m_historyCount = 0;
+    std::size_t m_period = 0;
+
+    void computeNextGeneration();
+    template <LifeBoundary Boundary>
+    void fillGuards(std::vector<std::uint64_t>& grid);
+    void clearGuards(std::vector<std::uint64_t>& grid);
+    template <LifeBoundary Boundary>
+    void markActiveTiles();
+    void computeTileRows(std::size_t beginTileRow, std::size_t endTileRow);
+    void computeTileRun(std::size_t tileY, std::size_t beginTileX, std::size_t endTileX);
+    void clearDecay(std::uint32_t startX, std::uint32_t startY, std::uint32_t sizeX, std::uint32_t sizeY);
+    void setSquare(std::uint32_t x, std::uint32_t y, bool value);
+    void markEdited(std::uint32_t startX, std::uint32_t startY, std::uint32_t sizeX, std::uint32_t sizeY);
+    void measureChangedTiles() const;
+    void measureTile(std::size_t tileX, std::size_t tileY) const;
+    void summarizeTileRow(std::size_t tileY) const;
+    void summarizeBoard() const;
+    void rehashTile(std::size_t tileX, std::size_t tileY, const std::vector<std::uint64_t>& grid);
+    void rehashBoard();
+    void forgetHistory();
+    void updateHash();
+    void recordHash();
+    std::size_t getWordIndex(std::uint32_t x, std::uint32_t y) const;
+};
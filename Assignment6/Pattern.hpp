@@ -4,7 +4,7 @@
 class Pattern
 {
   public:
-    virtual std::uint8_t getSizeX() const = 0;
-    virtual std::uint8_t getSizeY() const = 0;
-    virtual bool getCell(std::uint8_t x, std::uint8_t y) const = 0;
+    virtual std::uint32_t getSizeX() const = 0;
+    virtual std::uint32_t getSizeY() const = 0;
+    virtual bool getCell(std::uint32_t x, std::uint32_t y) const = 0;
 };
\ No newline at end of file
@@ -1,25 +1,11 @@
 #include "PatternAcorn.hpp"
 
-#include <vector>
-
-PatternAcorn::PatternAcorn()
-{
-    accorn = { { false, true, false, false, false, false, false },
-               { false, false, false, true, false, false, false },
-               { true, true, false, false, true, true, true } };
-}
-
-std::uint8_t PatternAcorn::getSizeX() const
+namespace
 {
-    return static_cast<std::uint8_t>(7);
+    constexpr auto ACORN = PatternEmbedded<7, 3>::decode("bo$3bo$2o2b3o!");
 }
 
-std::uint8_t PatternAcorn::getSizeY() const
+PatternAcorn::PatternAcorn() :
+    PatternEmbedded(ACORN)
 {
-    return static_cast<std::uint8_t>(3);
-}
-
-bool PatternAcorn::getCell(std::uint8_t x, std::uint8_t y) const
-{
-    return this->accorn[y][x];
-}
+}
\ No newline at end of file
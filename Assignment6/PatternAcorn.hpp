@@ -1,17 +1,8 @@
 #pragma once
-#include "Pattern.hpp"
+#include "PatternEmbedded.hpp"
 
-#include <cstdint>
-#include <vector>
-
-class PatternAcorn : public Pattern
+class PatternAcorn : public PatternEmbedded<7, 3>
 {
   public:
     PatternAcorn();
-    std::uint8_t getSizeX() const;
-    std::uint8_t getSizeY() const;
-    bool getCell(std::uint8_t x, std::uint8_t y) const;
-
-  private:
-    std::vector<std::vector<bool>> accorn;
-};
+};
\ No newline at end of file
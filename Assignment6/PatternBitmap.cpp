@@ -0,0 +1,182 @@
+#include "PatternBitmap.hpp"
+
+#include "PatternRle.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Largest pattern readRle() will allocate, 128 MiB of packed rows
+    const std::uint64_t MAX_RLE_CELLS = std::uint64_t{ 1 } << 30;
+
+    // Reads the value of `key` from an RLE header such as "x = 36, y = 9, rule = B3/S23"
+    std::uint32_t readHeaderValue(const std::string& header, char key)
+    {
+        for (std::size_t position = 0; position < header.size(); position++)
+        {
+            bool startsField = position == 0 || header[position - 1] == ',' || std::isspace(static_cast<unsigned char>(header[position - 1]));
+            if (!startsField || header[position] != key)
+            {
+                continue;
+            }
+
+            std::size_t equals = header.find_first_not_of(" \t", position + 1);
+            if (equals == std::string::npos || header[equals] != '=')
+            {
+                continue;
+            }
+
+            std::size_t digits = header.find_first_not_of(" \t", equals + 1);
+            std::uint64_t value = 0;
+            std::size_t end = digits;
+            while (end < header.size() && std::isdigit(static_cast<unsigned char>(header[end])) && value <= UINT32_MAX)
+            {
+                value = value * 10 + static_cast<std::uint64_t>(header[end] - '0');
+                end++;
+            }
+            if (end == digits || value > UINT32_MAX)
+            {
+                break;
+            }
+            return static_cast<std::uint32_t>(value);
+        }
+        throw std::runtime_error(std::string("RLE header has no valid '") + key + "' field");
+    }
+}
+
+PatternBitmap::PatternBitmap(std::uint32_t sizeX, std::uint32_t sizeY) :
+    m_sizeX(sizeX),
+    m_sizeY(sizeY),
+    m_wordsPerRow((static_cast<std::size_t>(sizeX) + 63) / 64),
+    m_rows(m_wordsPerRow * sizeY, 0)
+{
+}
+
+PatternBitmap PatternBitmap::readRle(std::istream& input)
+{
+    std::string header;
+    while (std::getline(input, header) && (header.empty() || header[0] == '#' || header.find_first_not_of(" \t\r") == std::string::npos))
+    {
+    }
+    if (!input)
+    {
+        throw std::runtime_error("RLE pattern has no header");
+    }
+
+    // The header is checked before anything is allocated, as a few empty-row runs can claim any size
+    std::uint32_t sizeX = readHeaderValue(header, 'x');
+    std::uint32_t sizeY = readHeaderValue(header, 'y');
+    if (static_cast<std::uint64_t>(sizeX) * sizeY > MAX_RLE_CELLS)
+    {
+        throw std::runtime_error("RLE pattern of " + std::to_string(sizeX) + "x" + std::to_string(sizeY) + " cells is too large");
+    }
+
+    PatternBitmap pattern(sizeX, sizeY);
+    std::streambuf* buffer = input.rdbuf();
+
+    decodeRle(
+        [buffer]()
+        {
+            auto c = buffer->sbumpc();
+            return c == std::streambuf::traits_type::eof() ? '\0' : static_cast<char>(c);
+        },
+        [&pattern](std::uint64_t x, std::uint64_t y, std::uint64_t length)
+        {
+            setPackedRun(&pattern.m_rows[y * pattern.m_wordsPerRow], x, length);
+        },
+        pattern.m_sizeX,
+        pattern.m_sizeY);
+    return pattern;
+}
+
+PatternBitmap PatternBitmap::readPlaintext(std::istream& input)
+{
+    // Rows may be ragged, so each one is packed into just the words it needs and the rows are
+    // spread out to a common width once the widest is known
+    std::vector<std::uint64_t> words;
+    std::vector<std::size_t> rowStarts;
+    std::size_t sizeX = 0;
+    std::string line;
+
+    while (std::getline(input, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty() && line[0] == '!')
+        {
+            continue;
+        }
+
+        rowStarts.push_back(words.size());
+        words.resize(words.size() + (line.size() + 63) / 64, 0);
+        for (std::size_t x = 0; x < line.size(); x++)
+        {
+            if (line[x] == 'O' || line[x] == '*')
+            {
+                words[rowStarts.back() + x / 64] |= std::uint64_t{ 1 } << (x % 64);
+            }
+            else if (line[x] != '.')
+            {
+                throw std::runtime_error("Unexpected character in plaintext pattern");
+            }
+        }
+        sizeX = std::max(sizeX, line.size());
+    }
+
+    if (sizeX > UINT32_MAX || rowStarts.size() > UINT32_MAX)
+    {
+        throw std::runtime_error("Plaintext pattern is too large");
+    }
+
+    PatternBitmap pattern(static_cast<std::uint32_t>(sizeX), static_cast<std::uint32_t>(rowStarts.size()));
+    rowStarts.push_back(words.size());
+    for (std::size_t y = 0; y + 1 < rowStarts.size(); y++)
+    {
+        std::copy(words.begin() + rowStarts[y], words.begin() + rowStarts[y + 1], pattern.m_rows.begin() + y * pattern.m_wordsPerRow);
+    }
+    return pattern;
+}
+
+PatternBitmap PatternBitmap::load(const std::string& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    if (!input)
+    {
+        throw std::runtime_error("Cannot open pattern file " + path);
+    }
+
+    std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == ".rle" ? readRle(input) : readPlaintext(input);
+}
+
+std::uint32_t PatternBitmap::getSizeX() const
+{
+    return m_sizeX;
+}
+
+std::uint32_t PatternBitmap::getSizeY() const
+{
+    return m_sizeY;
+}
+
+const std::uint64_t* PatternBitmap::getRow(std::uint32_t y) const
+{
+    return m_rows.data() + y * m_wordsPerRow;
+}
+
+void PatternBitmap::setCell(std::uint32_t x, std::uint32_t y, bool value)
+{
+    std::uint64_t bit = std::uint64_t{ 1 } << (x % 64);
+    std::uint64_t& word = m_rows[y * m_wordsPerRow + x / 64];
+    word = value ? (word | bit) : (word & ~bit);
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "PatternPacked.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Pattern of any size held as packed rows, usually read from a pattern file. The readers throw
+// std::runtime_error when the input is not a valid pattern.
+class PatternBitmap : public PatternPacked
+{
+  public:
+    PatternBitmap(std::uint32_t sizeX, std::uint32_t sizeY);
+
+    // Run length encoded patterns (.rle), decoded straight into the packed rows in one pass. Headers
+    // claiming more than 2^30 cells are rejected before anything is allocated.
+    static PatternBitmap readRle(std::istream& input);
+    // Plaintext patterns (.cells): 'O' is alive, '.' is dead and lines starting with '!' are comments
+    static PatternBitmap readPlaintext(std::istream& input);
+    // Chooses the reader from the file extension, plaintext unless it is .rle
+    static PatternBitmap load(const std::string& path);
+
+    std::uint32_t getSizeX() const override;
+    std::uint32_t getSizeY() const override;
+    const std::uint64_t* getRow(std::uint32_t y) const override;
+
+    void setCell(std::uint32_t x, std::uint32_t y, bool value);
+
+  private:
+    std::uint32_t m_sizeX;
+    std::uint32_t m_sizeY;
+    std::size_t m_wordsPerRow;
+    std::vector<std::uint64_t> m_rows;
+};
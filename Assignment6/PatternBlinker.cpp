@@ -1,23 +1,11 @@
 #include "PatternBlinker.hpp"
 
-#include <vector>
-
-PatternBlinker::PatternBlinker()
-{
-    blinker = { { true }, { true }, { true } };
-}
-
-std::uint8_t PatternBlinker::getSizeX() const
-{
-    return static_cast<std::uint8_t>(1);
-}
-
-std::uint8_t PatternBlinker::getSizeY() const
+namespace
 {
-    return static_cast<std::uint8_t>(3);
+    constexpr auto BLINKER = PatternEmbedded<1, 3>::decode("o$o$o!");
 }
 
-bool PatternBlinker::getCell(std::uint8_t x, std::uint8_t y) const
+PatternBlinker::PatternBlinker() :
+    PatternEmbedded(BLINKER)
 {
-    return this->blinker[y][x];
 }
\ No newline at end of file
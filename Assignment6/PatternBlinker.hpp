@@ -1,18 +1,8 @@
 #pragma once
+#include "PatternEmbedded.hpp"
 
-#include "Pattern.hpp"
-
-#include <cstdint>
-#include <vector>
-
-class PatternBlinker : public Pattern
+class PatternBlinker : public PatternEmbedded<1, 3>
 {
   public:
     PatternBlinker();
-    std::uint8_t getSizeX() const;
-    std::uint8_t getSizeY() const;
-    bool getCell(std::uint8_t x, std::uint8_t y) const;
-
-  private:
-    std::vector<std::vector<bool>> blinker;
 };
\ No newline at end of file
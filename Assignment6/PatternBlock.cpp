@@ -1,27 +1,11 @@
 #include "PatternBlock.hpp"
 
-#include <vector>
-
-PatternBlock::PatternBlock()
-{
-    block = { {
-                  true,
-                  true,
-              },
-              { true, true } };
-};
-
-std::uint8_t PatternBlock::getSizeX() const
-{
-    return static_cast<std::uint8_t>(2);
-}
-
-std::uint8_t PatternBlock::getSizeY() const
+namespace
 {
-    return static_cast<std::uint8_t>(2);
+    constexpr auto BLOCK = PatternEmbedded<2, 2>::decode("2o$2o!");
 }
 
-bool PatternBlock::getCell(std::uint8_t x, std::uint8_t y) const
+PatternBlock::PatternBlock() :
+    PatternEmbedded(BLOCK)
 {
-    return this->block[x][y];
 }
\ No newline at end of file
@@ -1,16 +1,8 @@
 #pragma once
-#include "Pattern.hpp"
+#include "PatternEmbedded.hpp"
 
-#include <vector>
-
-class PatternBlock : public Pattern
+class PatternBlock : public PatternEmbedded<2, 2>
 {
   public:
     PatternBlock();
-    std::uint8_t getSizeX() const;
-    std::uint8_t getSizeY() const;
-    bool getCell(std::uint8_t x, std::uint8_t y) const;
-
-  private:
-    std::vector<std::vector<bool>> block;
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include "PatternPacked.hpp"
+#include "PatternRle.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Fixed-size pattern whose packed rows are built into the program. decode() runs the RLE decoder
+// at compile time when its result initializes a constexpr variable:
+//
+//     constexpr auto GLIDER = PatternEmbedded<3, 3>::decode("2bo$obo$b2o!");
+template <std::uint32_t SizeX, std::uint32_t SizeY>
+class PatternEmbedded : public PatternPacked
+{
+  public:
+    static constexpr std::size_t WORDS_PER_ROW = (SizeX + 63) / 64;
+    using Rows = std::array<std::uint64_t, WORDS_PER_ROW * SizeY>;
+
+    constexpr explicit PatternEmbedded(const Rows& rows) :
+        m_rows(rows)
+    {
+    }
+
+    static constexpr Rows decode(std::string_view rle)
+    {
+        Rows rows{};
+        std::size_t position = 0;
+        decodeRle([&]() { return position < rle.size() ? rle[position++] : '\0'; },
+                  [&](std::uint64_t x, std::uint64_t y, std::uint64_t length) { setPackedRun(&rows[y * WORDS_PER_ROW], x, length); },
+                  SizeX,
+                  SizeY);
+        return rows;
+    }
+
+    std::uint32_t getSizeX() const override { return SizeX; }
+    std::uint32_t getSizeY() const override { return SizeY; }
+    const std::uint64_t* getRow(std::uint32_t y) const override { return m_rows.data() + y * WORDS_PER_ROW; }
+
+  private:
+    Rows m_rows;
+};
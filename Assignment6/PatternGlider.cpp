@@ -1,25 +1,11 @@
 #include "PatternGlider.hpp"
 
-#include <vector>
-
-PatternGlider::PatternGlider()
-{
-    glider = { { false, false, true },
-               { true, false, true },
-               { false, true, true } };
-}
-
-std::uint8_t PatternGlider::getSizeX() const
-{
-    return static_cast<std::uint8_t>(3);
-}
-
-std::uint8_t PatternGlider::getSizeY() const
+namespace
 {
-    return static_cast<std::uint8_t>(3);
+    constexpr auto GLIDER = PatternEmbedded<3, 3>::decode("2bo$obo$b2o!");
 }
 
-bool PatternGlider::getCell(std::uint8_t x, std::uint8_t y) const
+PatternGlider::PatternGlider() :
+    PatternEmbedded(GLIDER)
 {
-    return this->glider[y][x];
 }
\ No newline at end of file
@@ -1,16 +1,8 @@
 #pragma once
-#include "Pattern.hpp"
+#include "PatternEmbedded.hpp"
 
-#include <vector>
-
-class PatternGlider : public Pattern
+class PatternGlider : public PatternEmbedded<3, 3>
 {
   public:
     PatternGlider();
-    std::uint8_t getSizeX() const;
-    std::uint8_t getSizeY() const;
-    bool getCell(std::uint8_t x, std::uint8_t y) const;
-
-  private:
-    std::vector<std::vector<bool>> glider;
 };
\ No newline at end of file
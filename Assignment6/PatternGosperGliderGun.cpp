@@ -1,38 +1,11 @@
 #include "PatternGosperGliderGun.hpp"
 
-#include <vector>
-
-PatternGosperGliderGun::PatternGosperGliderGun()
+namespace
 {
-    gosperGliderGun = { { false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false },
-
-                        { false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, true, false, true, false, false, false, false, false, false, false, false, false, false, false },
-
-                        { false, false, false, false, false, false, false, false, false, false, false, false, true, true, false, false, false, false, false, false, true, true, false, false, false, false, false, false, false, false, false, false, false, false, true, true },
-
-                        { false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, true, false, false, false, false, true, true, false, false, false, false, false, false, false, false, false, false, false, false, true, true },
-
-                        { true, true, false, false, false, false, false, false, false, false, true, false, false, false, false, false, true, false, false, false, true, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false },
-
-                        { true, true, false, false, false, false, false, false, false, false, true, false, false, false, true, false, true, true, false, false, false, false, true, false, true, false, false, false, false, false, false, false, false, false, false, false },
-
-                        { false, false, false, false, false, false, false, false, false, false, true, false, false, false, false, false, true, false, false, false, false, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false },
-
-                        { false, false, false, false, false, false, false, false, false, false, false, true, false, false, false, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false },
-
-                        { false, false, false, false, false, false, false, false, false, false, false, false, true, true, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false, false } };
-}
-std::uint8_t PatternGosperGliderGun::getSizeX() const
-{
-    return static_cast<std::uint8_t>(36);
+    constexpr auto GOSPER_GLIDER_GUN = PatternEmbedded<36, 9>::decode("24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4bobo$10bo5bo7bo$11bo3bo$12b2o!");
 }
 
-std::uint8_t PatternGosperGliderGun::getSizeY() const
+PatternGosperGliderGun::PatternGosperGliderGun() :
+    PatternEmbedded(GOSPER_GLIDER_GUN)
 {
-    return static_cast<std::uint8_t>(9);
-}
-
-bool PatternGosperGliderGun::getCell(std::uint8_t x, std::uint8_t y) const
-{
-    return this->gosperGliderGun[y][x];
-}
+}
\ No newline at end of file
@@ -1,16 +1,8 @@
 #pragma once
-#include "Pattern.hpp"
+#include "PatternEmbedded.hpp"
 
-#include <vector>
-
-class PatternGosperGliderGun : public Pattern
+class PatternGosperGliderGun : public PatternEmbedded<36, 9>
 {
   public:
     PatternGosperGliderGun();
-    std::uint8_t getSizeX() const;
-    std::uint8_t getSizeY() const;
-    bool getCell(std::uint8_t x, std::uint8_t y) const;
-
-  private:
-    std::vector<std::vector<bool>> gosperGliderGun;
 };
\ No newline at end of file
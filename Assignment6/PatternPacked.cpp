@@ -0,0 +1,13 @@
+#include "PatternPacked.hpp"
+
+#include <cstdint>
+
+std::size_t PatternPacked::getWordsPerRow() const
+{
+    return (static_cast<std::size_t>(this->getSizeX()) + 63) / 64;
+}
+
+bool PatternPacked::getCell(std::uint32_t x, std::uint32_t y) const
+{
+    return (this->getRow(y)[x / 64] >> (x % 64)) & 1;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "Pattern.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+// Pattern stored as packed rows in the layout LifeSimulator uses: 64 cells per word, cell x in
+// bit x % 64 of word x / 64, and every bit past the right edge clear. Simulators can copy these
+// rows a word at a time instead of asking for every cell.
+class PatternPacked : public Pattern
+{
+  public:
+    virtual const std::uint64_t* getRow(std::uint32_t y) const = 0;
+    std::size_t getWordsPerRow() const;
+    bool getCell(std::uint32_t x, std::uint32_t y) const override;
+};
@@ -1,49 +1,11 @@
 #include "PatternPulsar.hpp"
 
-#include <vector>
-
-PatternPulsar::PatternPulsar()
-{
-    this->patternPulsar = {
-        { false, false, true, true, true, false, false, false, true, true, true, false, false },
-
-        { false, false, false, false, false, false, false, false, false, false, false, false, false },
-
-        { true, false, false, false, false, true, false, true, false, false, false, false, true },
-
-        { true, false, false, false, false, true, false, true, false, false, false, false, true },
-
-        { true, false, false, false, false, true, false, true, false, false, false, false, true },
-
-        { false, false, true, true, true, false, false, false, true, true, true, false, false },
-
-        { false, false, false, false, false, false, false, false, false, false, false, false, false },
-
-        { false, false, true, true, true, false, false, false, true, true, true, false, false },
-
-        { true, false, false, false, false, true, false, true, false, false, false, false, true },
-
-        { true, false, false, false, false, true, false, true, false, false, false, false, true },
-
-        { true, false, false, false, false, true, false, true, false, false, false, false, true },
-
-        { false, false, false, false, false, false, false, false, false, false, false, false, false },
-
-        { false, false, true, true, true, false, false, false, true, true, true, false, false },
-    };
-}
-
-std::uint8_t PatternPulsar::getSizeX() const
+namespace
 {
-    return static_cast<std::uint8_t>(13);
+    constexpr auto PULSAR = PatternEmbedded<13, 13>::decode("2b3o3b3o$$o4bobo4bo$o4bobo4bo$o4bobo4bo$2b3o3b3o$$2b3o3b3o$o4bobo4bo$o4bobo4bo$o4bobo4bo$$2b3o3b3o!");
 }
 
-std::uint8_t PatternPulsar::getSizeY() const
+PatternPulsar::PatternPulsar() :
+    PatternEmbedded(PULSAR)
 {
-    return static_cast<std::uint8_t>(13);
-}
-
-bool PatternPulsar::getCell(std::uint8_t x, std::uint8_t y) const
-{
-    return this->patternPulsar[y][x];
-}
+}
\ No newline at end of file
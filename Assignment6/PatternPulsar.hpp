@@ -1,16 +1,8 @@
 #pragma once
-#include "Pattern.hpp"
+#include "PatternEmbedded.hpp"
 
-#include <vector>
-
-class PatternPulsar : public Pattern
+class PatternPulsar : public PatternEmbedded<13, 13>
 {
   public:
     PatternPulsar();
-    std::uint8_t getSizeX() const;
-    std::uint8_t getSizeY() const;
-    bool getCell(std::uint8_t x, std::uint8_t y) const;
-
-  private:
-    std::vector<std::vector<bool>> patternPulsar;
 };
\ No newline at end of file
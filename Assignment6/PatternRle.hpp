@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+// Sets `length` cells of a packed row starting at column x, a word at a time
+constexpr void setPackedRun(std::uint64_t* row, std::uint64_t x, std::uint64_t length)
+{
+    while (length > 0)
+    {
+        std::uint64_t shift = x % 64;
+        std::uint64_t count = (length < 64 - shift) ? length : 64 - shift;
+        std::uint64_t bits = (count == 64) ? ~std::uint64_t{ 0 } : ((std::uint64_t{ 1 } << count) - 1);
+        row[x / 64] |= bits << shift;
+        x += count;
+        length -= count;
+    }
+}
+
+// Decodes the body of a run length encoded pattern, everything after the "x = .., y = .." line.
+// `next` returns the next character, or '\0' at the end of the input, and `setRun(x, y, length)`
+// is called for every run of live cells. Single-letter states A-Z count as alive. Being constexpr,
+// the same decoder turns string literals into patterns at compile time.
+template <typename Next, typename SetRun>
+constexpr void decodeRle(Next&& next, SetRun&& setRun, std::uint32_t sizeX, std::uint32_t sizeY)
+{
+    std::uint64_t x = 0;
+    std::uint64_t y = 0;
+    std::uint64_t count = 0;
+
+    for (char c = next(); c != '!'; c = next())
+    {
+        if (c >= '0' && c <= '9')
+        {
+            count = count * 10 + static_cast<std::uint64_t>(c - '0');
+            if (count > (std::uint64_t{ 1 } << 32))
+            {
+                throw std::runtime_error("RLE run length is too long");
+            }
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            continue;
+        }
+        if (c == '\0')
+        {
+            throw std::runtime_error("RLE pattern ends without '!'");
+        }
+
+        std::uint64_t run = (count == 0) ? 1 : count;
+        count = 0;
+
+        if (c == '$')
+        {
+            y += run;
+            x = 0;
+            continue;
+        }
+
+        bool alive = c == 'o' || (c >= 'A' && c <= 'Z');
+        if (!alive && c != 'b' && c != '.')
+        {
+            throw std::runtime_error("Unexpected character in RLE pattern");
+        }
+        if (alive)
+        {
+            if (x + run > sizeX || y >= sizeY)
+            {
+                throw std::runtime_error("RLE pattern is larger than its declared size");
+            }
+            setRun(x, y, run);
+        }
+        x += run;
+    }
+}
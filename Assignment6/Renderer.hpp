@@ -1,8 +1,11 @@
 #pragma once
+#include "LifeFrame.hpp"
 #include "LifeSimulator.hpp"
 
 class Renderer
 {
   public:
     virtual void render(const LifeSimulator& simulation) = 0;
+    // Draws a frame captured from a simulator, usually one stepping on another thread
+    virtual void render(const LifeFrame& frame) = 0;
 };
@@ -1,22 +1,132 @@
-// only look at changed positions in the renderer
 #include "RendererConsole.hpp"
 
+#include "LifeFrame.hpp"
 #include "LifeSimulator.hpp"
 #include "rlutil.h"
 
-void RendererConsole::render(const LifeSimulator& lifeSimulator)
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+    // Under Generations rules live cells are yellow and decaying ones fade from light red to dark grey
+    const int LIVE_COLOR = rlutil::YELLOW;
+    const int DECAY_COLORS[] = { rlutil::LIGHTRED, rlutil::RED, rlutil::MAGENTA, rlutil::BLUE, rlutil::DARKGREY };
+    const int DEFAULT_COLOR = -1;
+}
+
+// Simulators and frames both hand out packed rows
+template <typename Board>
+void RendererConsole::draw(const Board& board)
 {
-    rlutil::cls();
+    std::size_t wordsPerRow = board.getWordsPerRow();
+
+    m_output.clear();
+    m_cursorX = m_cursorY = UINT32_MAX;
+    if (board.getSizeX() != m_drawnSizeX || board.getSizeY() != m_drawnSizeY)
+    {
+        // Start from a blank screen; after that only cells that changed are drawn
+        rlutil::cls();
+        m_drawn.assign(wordsPerRow * board.getSizeY(), 0);
+        m_drawnDecaying.assign(m_drawn.size(), 0);
+        m_drawnSizeX = board.getSizeX();
+        m_drawnSizeY = board.getSizeY();
+    }
 
-    for (std::uint8_t i = 0; i < lifeSimulator.getSizeX(); i++)
+    for (std::uint32_t y = 0; y < board.getSizeY(); y++)
     {
-        for (std::uint8_t j = 0; j < lifeSimulator.getSizeY(); j++)
+        const std::uint64_t* row = board.getRow(y);
+        const std::uint64_t* decaying = board.getDecayingRow(y);
+        std::uint64_t* drawn = &m_drawn[y * wordsPerRow];
+        std::uint64_t* drawnDecaying = &m_drawnDecaying[y * wordsPerRow];
+
+        for (std::size_t word = 0; word < wordsPerRow; word++)
         {
-            if (lifeSimulator.getCell(i, j))
+            // Decaying cells move to another state every generation, so they are always redrawn
+            std::uint64_t decayingWord = decaying ? decaying[word] : 0;
+            for (std::uint64_t changed = (row[word] ^ drawn[word]) | decayingWord | drawnDecaying[word]; changed != 0; changed &= changed - 1)
             {
-                rlutil::locate(i, j);
-                rlutil::setChar('X');
+                int bit = std::countr_zero(changed);
+                std::uint32_t x = static_cast<std::uint32_t>(word * 64 + bit);
+                std::uint8_t state = ((decayingWord >> bit) & 1) ? board.getState(x, y) : static_cast<std::uint8_t>((row[word] >> bit) & 1);
+                this->appendCell(x, y, state, decaying != nullptr);
             }
+            drawn[word] = row[word];
+            drawnDecaying[word] = decayingWord;
         }
     }
-}
\ No newline at end of file
+
+    if (m_color != DEFAULT_COLOR)
+    {
+        this->setColor(DEFAULT_COLOR);
+    }
+
+#if defined(_WIN32) && !defined(RLUTIL_USE_ANSI)
+    // appendCell already drew through the console API
+#else
+    std::cout.write(m_output.data(), static_cast<std::streamsize>(m_output.size()));
+    std::cout.flush();
+#endif
+}
+
+void RendererConsole::render(const LifeSimulator& simulation)
+{
+    this->draw(simulation);
+}
+
+void RendererConsole::render(const LifeFrame& frame)
+{
+    this->draw(frame);
+}
+
+void RendererConsole::setColor(int color)
+{
+#if defined(_WIN32) && !defined(RLUTIL_USE_ANSI)
+    rlutil::setColor(color == DEFAULT_COLOR ? rlutil::GREY : color);
+#else
+    m_output.append(color == DEFAULT_COLOR ? rlutil::ANSI_ATTRIBUTE_RESET : rlutil::getANSIColor(color));
+#endif
+    m_color = color;
+}
+
+void RendererConsole::appendCell(std::uint32_t x, std::uint32_t y, std::uint8_t state, bool colored)
+{
+    int color = DEFAULT_COLOR;
+    if (colored && state == 1)
+    {
+        color = LIVE_COLOR;
+    }
+    else if (state > 1)
+    {
+        color = DECAY_COLORS[std::min<std::size_t>(state - 2, std::size(DECAY_COLORS) - 1)];
+    }
+    if (color != m_color && state != 0)
+    {
+        this->setColor(color);
+    }
+    char symbol = (state == 0) ? ' ' : (state == 1 ? 'X' : 'x');
+
+#if defined(_WIN32) && !defined(RLUTIL_USE_ANSI)
+    rlutil::locate(x + 1, y + 1);
+    rlutil::setChar(symbol);
+#else
+    // Writing a character leaves the cursor just after it, so neighbouring cells need no move
+    if (x != m_cursorX || y != m_cursorY)
+    {
+        char number[16];
+        m_output.append("\033[");
+        m_output.append(number, std::to_chars(number, number + sizeof(number), y + 1).ptr);
+        m_output.push_back(';');
+        m_output.append(number, std::to_chars(number, number + sizeof(number), x + 1).ptr);
+        m_output.push_back('H');
+    }
+
+    m_output.push_back(symbol);
+    m_cursorX = x + 1;
+    m_cursorY = y;
+#endif
+}
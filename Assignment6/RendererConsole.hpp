@@ -1,9 +1,34 @@
 #pragma once
+#include "LifeFrame.hpp"
 #include "LifeSimulator.hpp"
 #include "Renderer.hpp"
 
+#include <cstdint>
+#include <string>
+#include <vector>
+
 class RendererConsole : public Renderer
 {
   public:
     void render(const LifeSimulator& simulation) override;
+    void render(const LifeFrame& frame) override;
+
+  private:
+    // The frame currently on the terminal, packed the same way as LifeSimulator rows
+    std::vector<std::uint64_t> m_drawn;
+    std::vector<std::uint64_t> m_drawnDecaying;
+    std::uint32_t m_drawnSizeX = 0;
+    std::uint32_t m_drawnSizeY = 0;
+    // ANSI cursor moves and characters for one frame, written to the terminal at once
+    std::string m_output;
+    std::uint32_t m_cursorX = 0;
+    std::uint32_t m_cursorY = 0;
+    // rlutil colour of the text being written, -1 for the terminal's default
+    int m_color = -1;
+
+    template <typename Board>
+    void draw(const Board& board);
+    void setColor(int color);
+    // Colours live cells only when the board has decaying cells as well
+    void appendCell(std::uint32_t x, std::uint32_t y, std::uint8_t state, bool colored);
 };
@@ -0,0 +1,287 @@
+#include "RendererImage.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace
+{
+    // Cells are first turned into palette indexes: 0 dead, 1 live, then decaying cells by age
+    const std::uint8_t GREYS[] = { 0, 255, 192, 144, 104, 72, 48 };
+    // The console renderer's colours: white, or yellow when some cells are decaying, fading from light red to dark grey
+    const std::uint8_t COLORS[][3] = { { 0, 0, 0 }, { 255, 255, 255 }, { 255, 85, 85 }, { 170, 0, 0 }, { 170, 0, 170 }, { 0, 0, 170 }, { 85, 85, 85 } };
+    const std::uint8_t DECAYING_LIVE_COLOR[3] = { 255, 255, 85 };
+    const std::size_t PALETTE_SIZE = std::size(GREYS);
+
+    // Eight packed cells spread to eight bytes of 0 or 1, in the order they appear on screen
+    std::array<std::uint64_t, 256> makeSpreadTable()
+    {
+        std::array<std::uint64_t, 256> table{};
+        for (std::size_t bits = 0; bits < 256; bits++)
+        {
+            std::uint8_t cells[8];
+            for (std::size_t bit = 0; bit < 8; bit++)
+            {
+                cells[bit] = (bits >> bit) & 1;
+            }
+            std::memcpy(&table[bits], cells, sizeof(cells));
+        }
+        return table;
+    }
+
+    const std::array<std::uint64_t, 256> SPREAD = makeSpreadTable();
+}
+
+RendererImage::RendererImage(const std::string& path, std::uint32_t scale, bool animate, std::size_t queueLength) :
+    m_path(path),
+    m_scale(scale),
+    m_animate(animate)
+{
+    if (scale == 0 || queueLength == 0)
+    {
+        throw std::invalid_argument("Images need a scale and a queue of at least one frame");
+    }
+
+    std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    m_color = extension == ".ppm";
+
+    // Fail now rather than on the first frame, long after the caller could have reported it
+    std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    if (animate)
+    {
+        m_stream.open(path, std::ios::binary);
+    }
+    if ((animate && !m_stream.is_open()) || (!directory.empty() && !std::filesystem::is_directory(directory)))
+    {
+        throw std::runtime_error("Cannot write image " + path);
+    }
+
+    for (std::size_t i = 0; i < queueLength; i++)
+    {
+        m_spareFrames.push_back(std::make_unique<LifeFrame>());
+    }
+    m_thread = std::thread([this]() { this->writerLoop(); });
+}
+
+RendererImage::~RendererImage()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_frameReady.notify_one();
+    m_thread.join();
+}
+
+void RendererImage::render(const LifeSimulator& simulation)
+{
+    std::unique_ptr<LifeFrame> frame = this->takeSpareFrame();
+    frame->capture(simulation);
+    this->queueFrame(std::move(frame));
+}
+
+void RendererImage::render(const LifeFrame& frame)
+{
+    std::unique_ptr<LifeFrame> copy = this->takeSpareFrame();
+    // Assigning reuses the spare frame's buffers
+    *copy = frame;
+    this->queueFrame(std::move(copy));
+}
+
+void RendererImage::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_framesDone.wait(lock, [this]() { return m_frames.empty() && !m_writing; });
+
+    if (m_error)
+    {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+std::string RendererImage::getFramePath(std::uint64_t frame) const
+{
+    std::string number = std::to_string(frame);
+    number.insert(0, number.size() < 6 ? 6 - number.size() : 0, '0');
+
+    // The number goes before the extension, if the file name has one
+    std::size_t dot = m_path.find_last_of('.');
+    std::size_t separator = m_path.find_last_of("/\\");
+    if (dot == std::string::npos || (separator != std::string::npos && dot < separator))
+    {
+        dot = m_path.size();
+    }
+    return m_path.substr(0, dot) + "-" + number + m_path.substr(dot);
+}
+
+std::unique_ptr<LifeFrame> RendererImage::takeSpareFrame()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_frameFree.wait(lock, [this]() { return !m_spareFrames.empty(); });
+
+    std::unique_ptr<LifeFrame> frame = std::move(m_spareFrames.back());
+    m_spareFrames.pop_back();
+    return frame;
+}
+
+void RendererImage::queueFrame(std::unique_ptr<LifeFrame> frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frames.push_back(std::move(frame));
+    }
+    m_frameReady.notify_one();
+}
+
+void RendererImage::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_frameReady.wait(lock, [this]() { return m_stopping || !m_frames.empty(); });
+        if (m_frames.empty())
+        {
+            return;
+        }
+
+        std::unique_ptr<LifeFrame> frame = std::move(m_frames.front());
+        m_frames.pop_front();
+        m_writing = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+            this->encode(*frame);
+
+            std::string path = m_animate ? m_path : this->getFramePath(m_written);
+            if (!m_animate)
+            {
+                m_stream = std::ofstream(path, std::ios::binary);
+            }
+            else if (!m_stream.is_open())
+            {
+                // Reopening after a failed write keeps the frames already recorded and drops only
+                // the part of the failed frame that made it to the file
+                std::error_code ignored;
+                std::filesystem::resize_file(path, m_animatedBytes, ignored);
+                m_stream.open(path, std::ios::binary | std::ios::app);
+            }
+            m_stream.write(m_image.data(), static_cast<std::streamsize>(m_image.size()));
+            m_stream.flush();
+            if (!m_stream)
+            {
+                m_stream = std::ofstream();
+                throw std::runtime_error("Cannot write image " + path);
+            }
+            m_animatedBytes += m_image.size();
+            m_written++;
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error && !m_error)
+        {
+            m_error = error;
+        }
+        m_spareFrames.push_back(std::move(frame));
+        m_frameFree.notify_one();
+        m_writing = false;
+        if (m_frames.empty())
+        {
+            m_framesDone.notify_all();
+        }
+    }
+}
+
+void RendererImage::encode(const LifeFrame& frame)
+{
+    std::size_t wordsPerRow = frame.getWordsPerRow();
+    std::size_t channels = m_color ? 3 : 1;
+    std::size_t sizeX = static_cast<std::size_t>(frame.getSizeX()) * m_scale;
+    std::size_t sizeY = static_cast<std::size_t>(frame.getSizeY()) * m_scale;
+    std::size_t lineSize = sizeX * channels;
+
+    std::string header = (m_color ? "P6\n" : "P5\n") + std::to_string(sizeX) + " " + std::to_string(sizeY) + "\n255\n";
+    m_image.resize(header.size() + lineSize * sizeY);
+    std::copy(header.begin(), header.end(), m_image.begin());
+    m_cells.resize(wordsPerRow * 64);
+
+    // Every palette entry as the bytes of one scaled cell
+    std::vector<char> pixels(PALETTE_SIZE * m_scale * channels);
+    for (std::size_t index = 0; index < PALETTE_SIZE; index++)
+    {
+        const std::uint8_t* color = (index == 1 && frame.getDecayingRow(0) != nullptr) ? DECAYING_LIVE_COLOR : COLORS[index];
+        for (std::size_t pixel = 0; pixel < m_scale; pixel++)
+        {
+            for (std::size_t channel = 0; channel < channels; channel++)
+            {
+                pixels[(index * m_scale + pixel) * channels + channel] = static_cast<char>(m_color ? color[channel] : GREYS[index]);
+            }
+        }
+    }
+
+    char* line = m_image.data() + header.size();
+    for (std::uint32_t y = 0; y < frame.getSizeY(); y++)
+    {
+        // Live cells are spread eight at a time, then decaying ones are written over the dead cells they left
+        const std::uint64_t* row = frame.getRow(y);
+        for (std::size_t word = 0; word < wordsPerRow; word++)
+        {
+            for (std::size_t byte = 0; byte < 8; byte++)
+            {
+                std::memcpy(&m_cells[word * 64 + byte * 8], &SPREAD[(row[word] >> (byte * 8)) & 0xff], 8);
+            }
+        }
+        if (const std::uint64_t* decaying = frame.getDecayingRow(y))
+        {
+            for (std::size_t word = 0; word < wordsPerRow; word++)
+            {
+                for (std::uint64_t bits = decaying[word]; bits != 0; bits &= bits - 1)
+                {
+                    std::uint32_t x = static_cast<std::uint32_t>(word * 64 + std::countr_zero(bits));
+                    m_cells[x] = static_cast<std::uint8_t>(std::min<std::size_t>(frame.getState(x, y), PALETTE_SIZE - 1));
+                }
+            }
+        }
+
+        std::size_t cellSize = m_scale * channels;
+        if (cellSize == 1)
+        {
+            for (std::uint32_t x = 0; x < frame.getSizeX(); x++)
+            {
+                line[x] = pixels[m_cells[x]];
+            }
+        }
+        else
+        {
+            for (std::uint32_t x = 0; x < frame.getSizeX(); x++)
+            {
+                std::memcpy(line + x * cellSize, &pixels[m_cells[x] * cellSize], cellSize);
+            }
+        }
+        // The other lines of a scaled row are the same as its first
+        for (std::uint32_t copy = 1; copy < m_scale; copy++)
+        {
+            std::memcpy(line + copy * lineSize, line, lineSize);
+        }
+        line += lineSize * m_scale;
+    }
+}
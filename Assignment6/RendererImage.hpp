@@ -0,0 +1,71 @@
+#pragma once
+#include "LifeFrame.hpp"
+#include "LifeSimulator.hpp"
+#include "Renderer.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes every rendered board as a binary Netpbm image: colour PPM when the path ends in .ppm,
+// greyscale PGM otherwise, with each cell drawn as a square of `scale` pixels. Without `animate`
+// frame n goes to its own file, "life.pgm" becoming "life-000000.pgm", "life-000001.pgm" and so
+// on; with it every frame is appended to the one file, which ffmpeg reads as an image2pipe stream.
+//
+// render() only copies the board into a spare frame; a background thread encodes and writes it.
+// At most `queueLength` frames wait at once, after which render() blocks until one is written.
+// The constructor throws std::runtime_error when the images cannot be written where asked.
+class RendererImage : public Renderer
+{
+  public:
+    RendererImage(const std::string& path, std::uint32_t scale = 1, bool animate = false, std::size_t queueLength = 4);
+    // Finishes the queued frames before returning
+    ~RendererImage();
+    RendererImage(const RendererImage&) = delete;
+    RendererImage& operator=(const RendererImage&) = delete;
+
+    void render(const LifeSimulator& simulation) override;
+    void render(const LifeFrame& frame) override;
+    // Blocks until every queued frame is on disk; rethrows the first error the writer hit
+    void wait();
+
+    // The file frame n is written to when frames are not animated
+    std::string getFramePath(std::uint64_t frame) const;
+
+  private:
+    std::string m_path;
+    std::uint32_t m_scale;
+    bool m_animate;
+    bool m_color;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_frameReady;
+    std::condition_variable m_frameFree;
+    std::condition_variable m_framesDone;
+    std::deque<std::unique_ptr<LifeFrame>> m_frames;
+    std::vector<std::unique_ptr<LifeFrame>> m_spareFrames;
+    bool m_writing = false;
+    bool m_stopping = false;
+    std::exception_ptr m_error;
+
+    // Only touched by the writer thread once it has started
+    std::uint64_t m_written = 0;
+    std::uint64_t m_animatedBytes = 0;
+    std::ofstream m_stream;
+    std::vector<std::uint8_t> m_cells;
+    std::vector<char> m_image;
+
+    std::unique_ptr<LifeFrame> takeSpareFrame();
+    void queueFrame(std::unique_ptr<LifeFrame> frame);
+    void writerLoop();
+    void encode(const LifeFrame& frame);
+};
@@ -0,0 +1,397 @@
+#include "SnapshotFile.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+static_assert(sizeof(SnapshotHeader) == 48, "The snapshot header is read straight from the file");
+static_assert(std::endian::native == std::endian::little, "Snapshots store words in little-endian order");
+
+namespace
+{
+    const std::uint64_t MAX_TOKEN_COUNT = 0xffffffff;
+
+    // Maps the whole file read-only; returns nullptr for an empty file
+    void* mapFile(const std::string& path, std::size_t& bytes)
+    {
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            throw std::runtime_error("Cannot open snapshot " + path);
+        }
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size))
+        {
+            CloseHandle(file);
+            throw std::runtime_error("Cannot read the size of snapshot " + path);
+        }
+        bytes = static_cast<std::size_t>(size.QuadPart);
+        if (bytes == 0)
+        {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (mapping)
+        {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+        {
+            throw std::runtime_error("Cannot open snapshot " + path);
+        }
+
+        struct stat status;
+        if (fstat(file, &status) != 0)
+        {
+            close(file);
+            throw std::runtime_error("Cannot read the size of snapshot " + path);
+        }
+        bytes = static_cast<std::size_t>(status.st_size);
+        if (bytes == 0)
+        {
+            close(file);
+            return nullptr;
+        }
+
+        void* view = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        if (view == MAP_FAILED)
+        {
+            view = nullptr;
+        }
+#endif
+        if (view == nullptr)
+        {
+            throw std::runtime_error("Cannot map snapshot " + path);
+        }
+        return view;
+    }
+
+    void unmapFile(void* view, std::size_t bytes)
+    {
+#if defined(_WIN32)
+        (void)bytes;
+        UnmapViewOfFile(view);
+#else
+        munmap(view, bytes);
+#endif
+    }
+
+    // Zero words are skipped; isolated zeros stay inside a literal run, where they cost less than a new token
+    std::vector<std::uint64_t> compressWords(const std::uint64_t* words, std::size_t count)
+    {
+        std::vector<std::uint64_t> tokens;
+        std::size_t position = 0;
+
+        while (position < count)
+        {
+            std::size_t zeros = 0;
+            while (position + zeros < count && words[position + zeros] == 0 && zeros < MAX_TOKEN_COUNT)
+            {
+                zeros++;
+            }
+            position += zeros;
+
+            std::size_t literals = 0;
+            while (position + literals < count && literals < MAX_TOKEN_COUNT)
+            {
+                bool zeroRun = words[position + literals] == 0 && (position + literals + 1 == count || words[position + literals + 1] == 0);
+                if (zeroRun)
+                {
+                    break;
+                }
+                literals++;
+            }
+
+            tokens.push_back(zeros | (static_cast<std::uint64_t>(literals) << 32));
+            tokens.insert(tokens.end(), words + position, words + position + literals);
+            position += literals;
+        }
+        return tokens;
+    }
+}
+
+SnapshotFile::SnapshotFile(const std::string& path)
+{
+    m_mapping = mapFile(path, m_mappingBytes);
+
+    if (m_mappingBytes < sizeof(SnapshotHeader))
+    {
+        this->unmap();
+        throw std::runtime_error("Snapshot " + path + " is too short");
+    }
+    std::memcpy(&m_header, m_mapping, sizeof(SnapshotHeader));
+
+    const std::uint64_t* payload = reinterpret_cast<const std::uint64_t*>(static_cast<const char*>(m_mapping) + sizeof(SnapshotHeader));
+    std::uint64_t payloadWords = (m_mappingBytes - sizeof(SnapshotHeader)) / sizeof(std::uint64_t);
+    m_wordsPerRow = (static_cast<std::size_t>(m_header.sizeX) + 63) / 64;
+    std::uint64_t boardWords = static_cast<std::uint64_t>(m_wordsPerRow) * m_header.sizeY;
+    // Each word of cells has a word of states for every byte in it
+    std::uint64_t ageWords = m_header.states > 2 ? boardWords * sizeof(std::uint64_t) : 0;
+    bool compressed = (m_header.flags & SnapshotHeader::FLAG_COMPRESSED) != 0;
+
+    if (std::memcmp(m_header.magic, SnapshotHeader::MAGIC, sizeof(m_header.magic)) != 0 || m_header.version != SnapshotHeader::VERSION)
+    {
+        this->unmap();
+        throw std::runtime_error(path + " is not a version " + std::to_string(SnapshotHeader::VERSION) + " snapshot");
+    }
+    if (m_header.states > 255 || m_header.boundary > static_cast<std::uint16_t>(LifeBoundary::Mirror))
+    {
+        this->unmap();
+        throw std::runtime_error("Snapshot " + path + " is corrupt");
+    }
+    if (m_header.payloadWords != payloadWords || (!compressed && payloadWords != boardWords + ageWords))
+    {
+        this->unmap();
+        throw std::runtime_error("Snapshot " + path + " is truncated");
+    }
+
+    if (!compressed)
+    {
+        m_rows = payload;
+    }
+    else
+    {
+        this->expand(payload, payloadWords, boardWords + ageWords, path);
+    }
+    if (ageWords != 0)
+    {
+        m_ages = reinterpret_cast<const std::uint8_t*>(m_rows + boardWords);
+        this->checkAges(path);
+    }
+}
+
+void SnapshotFile::expand(const std::uint64_t* payload, std::uint64_t payloadWords, std::uint64_t expandedWords, const std::string& path)
+{
+    // Walk the tokens before allocating, so a damaged header cannot ask for more words than the
+    // payload describes, which is at most 2^32 - 1 zeros and the literals per token
+    std::uint64_t described = 0;
+    for (std::uint64_t token = 0; token < payloadWords;)
+    {
+        std::uint64_t literals = payload[token] >> 32;
+        described += (payload[token] & MAX_TOKEN_COUNT) + literals;
+        token += 1 + literals;
+        if (described > expandedWords || token > payloadWords)
+        {
+            this->unmap();
+            throw std::runtime_error("Snapshot " + path + " is corrupt");
+        }
+    }
+    // The writer always describes every word of the board
+    if (described != expandedWords)
+    {
+        this->unmap();
+        throw std::runtime_error("Snapshot " + path + " is corrupt");
+    }
+
+    m_expanded.assign(expandedWords, 0);
+    std::uint64_t position = 0;
+    for (std::uint64_t token = 0; token < payloadWords;)
+    {
+        std::uint64_t zeros = payload[token] & MAX_TOKEN_COUNT;
+        std::uint64_t literals = payload[token] >> 32;
+        token++;
+
+        if (position + zeros + literals > expandedWords || token + literals > payloadWords)
+        {
+            this->unmap();
+            throw std::runtime_error("Snapshot " + path + " is corrupt");
+        }
+        position += zeros;
+        std::copy(payload + token, payload + token + literals, m_expanded.begin() + position);
+        position += literals;
+        token += literals;
+    }
+
+    this->unmap();
+    m_rows = m_expanded.data();
+}
+
+void SnapshotFile::checkAges(const std::string& path)
+{
+    // Restoring trusts the states, so one the rule does not have means the file is damaged
+    for (std::uint32_t y = 0; y < m_header.sizeY; y++)
+    {
+        const std::uint8_t* ages = this->getAgeRow(y);
+        for (std::uint32_t x = 0; x < m_header.sizeX; x++)
+        {
+            if (ages[x] == 1 || ages[x] >= m_header.states)
+            {
+                this->unmap();
+                throw std::runtime_error("Snapshot " + path + " is corrupt");
+            }
+        }
+    }
+}
+
+SnapshotFile::~SnapshotFile()
+{
+    this->unmap();
+}
+
+void SnapshotFile::unmap()
+{
+    if (m_mapping != nullptr)
+    {
+        unmapFile(m_mapping, m_mappingBytes);
+        m_mapping = nullptr;
+    }
+}
+
+std::uint32_t SnapshotFile::getSizeX() const
+{
+    return m_header.sizeX;
+}
+
+std::uint32_t SnapshotFile::getSizeY() const
+{
+    return m_header.sizeY;
+}
+
+const std::uint64_t* SnapshotFile::getRow(std::uint32_t y) const
+{
+    return m_rows + static_cast<std::size_t>(y) * m_wordsPerRow;
+}
+
+const std::uint8_t* SnapshotFile::getAgeRow(std::uint32_t y) const
+{
+    return m_ages == nullptr ? nullptr : m_ages + static_cast<std::size_t>(y) * m_wordsPerRow * 64;
+}
+
+std::uint64_t SnapshotFile::getGeneration() const
+{
+    return m_header.generation;
+}
+
+LifeRule SnapshotFile::getRule() const
+{
+    return LifeRule(m_header.birthCounts, m_header.survivalCounts, std::max<std::uint32_t>(m_header.states, 2));
+}
+
+LifeBoundary SnapshotFile::getBoundary() const
+{
+    return static_cast<LifeBoundary>(m_header.boundary);
+}
+
+bool SnapshotFile::isMapped() const
+{
+    return m_mapping != nullptr;
+}
+
+void SnapshotFile::write(const std::string& path, std::uint32_t sizeX, std::uint32_t sizeY, std::uint64_t generation, const LifeRule& rule, LifeBoundary boundary, const std::uint64_t* rows, const std::uint8_t* ages, bool compress)
+{
+    std::size_t boardWords = (static_cast<std::size_t>(sizeX) + 63) / 64 * sizeY;
+    std::size_t ageWords = rule.getStates() > 2 ? boardWords * sizeof(std::uint64_t) : 0;
+    if (ageWords != 0 && ages == nullptr)
+    {
+        throw std::invalid_argument("Snapshots of rule " + rule.toString() + " need the decaying states");
+    }
+
+    std::vector<std::uint64_t> tokens;
+    if (compress)
+    {
+        tokens = compressWords(rows, boardWords);
+        if (ageWords != 0)
+        {
+            // Token runs may end anywhere, so the states are compressed on their own and appended
+            std::vector<std::uint64_t> words(ageWords);
+            std::memcpy(words.data(), ages, ageWords * sizeof(std::uint64_t));
+            std::vector<std::uint64_t> ageTokens = compressWords(words.data(), ageWords);
+            tokens.insert(tokens.end(), ageTokens.begin(), ageTokens.end());
+        }
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+    header.version = SnapshotHeader::VERSION;
+    header.flags = compress ? SnapshotHeader::FLAG_COMPRESSED : 0;
+    header.sizeX = sizeX;
+    header.sizeY = sizeY;
+    header.generation = generation;
+    header.birthCounts = rule.getBirthCounts();
+    header.survivalCounts = rule.getSurvivalCounts();
+    header.states = static_cast<std::uint16_t>(rule.getStates());
+    header.boundary = static_cast<std::uint16_t>(boundary);
+    header.payloadWords = compress ? tokens.size() : boardWords + ageWords;
+
+    std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream output(temporaryPath, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (compress)
+        {
+            output.write(reinterpret_cast<const char*>(tokens.data()), static_cast<std::streamsize>(tokens.size() * sizeof(std::uint64_t)));
+        }
+        else
+        {
+            output.write(reinterpret_cast<const char*>(rows), static_cast<std::streamsize>(boardWords * sizeof(std::uint64_t)));
+            output.write(reinterpret_cast<const char*>(ages), static_cast<std::streamsize>(ageWords * sizeof(std::uint64_t)));
+        }
+        output.close();
+        if (!output)
+        {
+            std::filesystem::remove(temporaryPath);
+            throw std::runtime_error("Cannot write snapshot " + temporaryPath);
+        }
+    }
+    std::filesystem::rename(temporaryPath, path);
+}
+
+void SnapshotFile::write(const std::string& path, const LifeSimulator& simulation, bool compress)
+{
+    std::size_t wordsPerRow = simulation.getWordsPerRow();
+    std::vector<std::uint64_t> rows(wordsPerRow * simulation.getSizeY());
+    std::vector<std::uint8_t> ages(simulation.getAgeRow(0) != nullptr ? rows.size() * 64 : 0);
+    for (std::uint32_t y = 0; y < simulation.getSizeY(); y++)
+    {
+        std::copy(simulation.getRow(y), simulation.getRow(y) + wordsPerRow, rows.begin() + y * wordsPerRow);
+        if (!ages.empty())
+        {
+            std::copy(simulation.getAgeRow(y), simulation.getAgeRow(y) + wordsPerRow * 64, ages.begin() + y * wordsPerRow * 64);
+        }
+    }
+    write(path, simulation.getSizeX(), simulation.getSizeY(), simulation.getGeneration(), simulation.getRule(), simulation.getBoundary(), rows.data(), ages.empty() ? nullptr : ages.data(), compress);
+}
+
+LifeSimulator SnapshotFile::restore(const std::string& path)
+{
+    SnapshotFile snapshot(path);
+    LifeSimulator simulation(snapshot.getSizeX(), snapshot.getSizeY(), snapshot.getRule());
+    simulation.setBoundary(snapshot.getBoundary());
+
+    simulation.insertPattern(snapshot, 0, 0);
+    if (snapshot.getAgeRow(0) != nullptr)
+    {
+        for (std::uint32_t y = 0; y < snapshot.getSizeY(); y++)
+        {
+            simulation.setAgeRow(y, snapshot.getAgeRow(y));
+        }
+    }
+    simulation.setGeneration(snapshot.getGeneration());
+    return simulation;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "LifeBoundary.hpp"
+#include "LifeRule.hpp"
+#include "LifeSimulator.hpp"
+#include "PatternPacked.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Layout of a snapshot file: this header, then the rows packed 64 cells per word with no padding
+// between rows, so an uncompressed file can be mapped and used in place. Generations rules add
+// the decaying states after the rows, a byte per cell laid out like LifeSimulator::getAgeRow.
+// Compressed files hold tokens instead: the low half of a token counts zero words to skip, the
+// high half counts the literal words that follow it. Everything is little-endian.
+class SnapshotHeader
+{
+  public:
+    static constexpr char MAGIC[8] = { 'L', 'I', 'F', 'E', 'S', 'N', 'A', 'P' };
+    static constexpr std::uint32_t VERSION = 3;
+    static constexpr std::uint32_t FLAG_COMPRESSED = 1;
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t flags;
+    std::uint32_t sizeX;
+    std::uint32_t sizeY;
+    std::uint64_t generation;
+    std::uint16_t birthCounts;
+    std::uint16_t survivalCounts;
+    // States of a Generations rule; 0 or 2 for two-state rules
+    std::uint16_t states;
+    // A LifeBoundary value
+    std::uint16_t boundary;
+    // Number of 64-bit words after the header
+    std::uint64_t payloadWords;
+};
+
+// A snapshot read back from disk. Uncompressed snapshots are memory mapped and their rows used
+// without copying; compressed ones are expanded into memory. Throws std::runtime_error when the
+// file is missing, truncated or not a snapshot.
+class SnapshotFile : public PatternPacked
+{
+  public:
+    explicit SnapshotFile(const std::string& path);
+    ~SnapshotFile();
+    SnapshotFile(const SnapshotFile&) = delete;
+    SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    std::uint32_t getSizeX() const override;
+    std::uint32_t getSizeY() const override;
+    const std::uint64_t* getRow(std::uint32_t y) const override;
+    // Decaying states of row y; nullptr unless the rule is a Generations rule
+    const std::uint8_t* getAgeRow(std::uint32_t y) const;
+
+    std::uint64_t getGeneration() const;
+    LifeRule getRule() const;
+    LifeBoundary getBoundary() const;
+    bool isMapped() const;
+
+    // Writes sizeY rows of packed words to `path`, and the decaying states when the rule is a
+    // Generations rule, going through a temporary file so an existing snapshot is only replaced
+    // once the new one is complete
+    static void write(const std::string& path, std::uint32_t sizeX, std::uint32_t sizeY, std::uint64_t generation, const LifeRule& rule, LifeBoundary boundary, const std::uint64_t* rows, const std::uint8_t* ages, bool compress);
+    static void write(const std::string& path, const LifeSimulator& simulation, bool compress);
+    // Builds a simulator with the board, decaying states, rule, boundary and generation of the
+    // snapshot at `path`
+    static LifeSimulator restore(const std::string& path);
+
+  private:
+    SnapshotHeader m_header;
+    std::size_t m_wordsPerRow;
+    const std::uint64_t* m_rows = nullptr;
+    const std::uint8_t* m_ages = nullptr;
+    std::vector<std::uint64_t> m_expanded;
+    void* m_mapping = nullptr;
+    std::size_t m_mappingBytes = 0;
+
+    void expand(const std::uint64_t* payload, std::uint64_t payloadWords, std::uint64_t expandedWords, const std::string& path);
+    void checkAges(const std::string& path);
+    void unmap();
+};
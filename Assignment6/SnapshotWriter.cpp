@@ -0,0 +1,142 @@
+#include "SnapshotWriter.hpp"
+
+#include "SnapshotFile.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+SnapshotWriter::SnapshotWriter(std::size_t queueLength) :
+    m_queueLength(queueLength)
+{
+    if (queueLength == 0)
+    {
+        throw std::invalid_argument("Snapshots need a queue of at least one");
+    }
+    m_thread = std::thread([this]() { this->writerLoop(); });
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_jobReady.notify_one();
+    m_thread.join();
+}
+
+void SnapshotWriter::save(const LifeSimulator& simulation, const std::string& path, bool compress)
+{
+    std::unique_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto queued = std::find_if(m_jobs.begin(), m_jobs.end(), [&path](const std::unique_ptr<Job>& waiting) { return waiting->path == path; });
+        if (queued != m_jobs.end())
+        {
+            job = std::move(*queued);
+            m_jobs.erase(queued);
+        }
+        else if (!m_spareJobs.empty())
+        {
+            job = std::move(m_spareJobs.back());
+            m_spareJobs.pop_back();
+        }
+    }
+    if (!job)
+    {
+        job = std::make_unique<Job>();
+    }
+
+    // Freeze the board outside the lock; the writer thread never touches the simulator
+    std::size_t wordsPerRow = simulation.getWordsPerRow();
+    job->path = path;
+    job->compress = compress;
+    job->sizeX = simulation.getSizeX();
+    job->sizeY = simulation.getSizeY();
+    job->generation = simulation.getGeneration();
+    job->rule = simulation.getRule();
+    job->boundary = simulation.getBoundary();
+    job->rows.resize(wordsPerRow * job->sizeY);
+    job->ages.resize(simulation.getAgeRow(0) != nullptr ? job->rows.size() * 64 : 0);
+    for (std::uint32_t y = 0; y < job->sizeY; y++)
+    {
+        std::copy(simulation.getRow(y), simulation.getRow(y) + wordsPerRow, job->rows.begin() + y * wordsPerRow);
+        if (!job->ages.empty())
+        {
+            std::copy(simulation.getAgeRow(y), simulation.getAgeRow(y) + wordsPerRow * 64, job->ages.begin() + y * wordsPerRow * 64);
+        }
+    }
+
+    {
+        // A full queue holds up the caller, so a slow disk cannot make it grow without bound
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobFree.wait(lock, [this]() { return m_jobs.size() < m_queueLength; });
+        m_jobs.push_back(std::move(job));
+    }
+    m_jobReady.notify_one();
+}
+
+void SnapshotWriter::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_jobsDone.wait(lock, [this]() { return m_jobs.empty() && !m_writing; });
+
+    if (m_error)
+    {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+std::size_t SnapshotWriter::getQueuedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_jobs.size();
+}
+
+void SnapshotWriter::writerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true)
+    {
+        m_jobReady.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+        if (m_jobs.empty())
+        {
+            return;
+        }
+
+        std::unique_ptr<Job> job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_writing = true;
+        m_jobFree.notify_one();
+        lock.unlock();
+
+        std::exception_ptr error;
+        try
+        {
+            SnapshotFile::write(job->path, job->sizeX, job->sizeY, job->generation, job->rule, job->boundary, job->rows.data(), job->ages.empty() ? nullptr : job->ages.data(), job->compress);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        if (error && !m_error)
+        {
+            m_error = error;
+        }
+        m_spareJobs.push_back(std::move(job));
+        m_writing = false;
+        if (m_jobs.empty())
+        {
+            m_jobsDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "LifeRule.hpp"
+#include "LifeSimulator.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Writes snapshots on a background thread. save() only copies the board into a spare buffer, so
+// the stepping thread carries on while the file is written. A save to a path whose previous save
+// has not started yet replaces it; otherwise at most `queueLength` snapshots wait at once, after
+// which save() blocks until one has been written.
+class SnapshotWriter
+{
+  public:
+    SnapshotWriter(std::size_t queueLength = 4);
+    // Finishes the queued snapshots before returning
+    ~SnapshotWriter();
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void save(const LifeSimulator& simulation, const std::string& path, bool compress = false);
+    // Blocks until every queued snapshot is on disk; rethrows the first error the writer hit
+    void wait();
+    // Snapshots queued but not yet being written
+    std::size_t getQueuedCount() const;
+
+  private:
+    class Job
+    {
+      public:
+        std::string path;
+        bool compress;
+        std::uint32_t sizeX;
+        std::uint32_t sizeY;
+        std::uint64_t generation;
+        LifeRule rule;
+        LifeBoundary boundary;
+        std::vector<std::uint64_t> rows;
+        // Empty unless the rule is a Generations rule
+        std::vector<std::uint8_t> ages;
+    };
+
+    std::thread m_thread;
+    std::size_t m_queueLength;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_jobFree;
+    std::condition_variable m_jobsDone;
+    std::deque<std::unique_ptr<Job>> m_jobs;
+    // Jobs whose buffers can be reused by the next save
+    std::vector<std::unique_ptr<Job>> m_spareJobs;
+    bool m_writing = false;
+    bool m_stopping = false;
+    std::exception_ptr m_error;
+
+    void writerLoop();
+};
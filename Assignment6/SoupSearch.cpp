@@ -0,0 +1,172 @@
+#include "SoupSearch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+void SoupSearchResult::merge(const SoupSearchResult& other)
+{
+    soups += other.soups;
+    stabilized += other.stabilized;
+    generations += other.generations;
+    population += other.population;
+    objects += other.objects;
+    for (std::size_t period = 0; period < periods.size(); period++)
+    {
+        periods[period] += other.periods[period];
+    }
+    for (std::size_t size = 0; size < objectSizes.size(); size++)
+    {
+        objectSizes[size] += other.objectSizes[size];
+    }
+}
+
+SoupSearch::Worker::Worker(const SoupSearchOptions& options) :
+    simulation(options.boardSize, options.boardSize, options.rule),
+    soup(options.soupSize, options.soupSize)
+{
+    simulation.setPeriodDetection(true);
+}
+
+SoupSearch::SoupSearch(const SoupSearchOptions& options) :
+    m_options(options),
+    m_threadPool(options.threads)
+{
+    if (options.soupSize == 0 || options.soupSize > options.boardSize)
+    {
+        throw std::invalid_argument("The soup has to fit on the board");
+    }
+    if (options.density < 0 || options.density > 1)
+    {
+        throw std::invalid_argument("The soup density has to be between 0 and 1");
+    }
+
+    for (std::size_t thread = 0; thread < m_threadPool.getThreadCount(); thread++)
+    {
+        m_workers.push_back(std::make_unique<Worker>(options));
+    }
+}
+
+SoupSearchResult SoupSearch::run(std::uint64_t firstSoup, std::uint64_t count)
+{
+    for (auto& worker : m_workers)
+    {
+        worker->result = SoupSearchResult();
+    }
+
+    // Soups that die out quickly and soups that run for thousands of generations are mixed
+    // together, so idle threads steal soups rather than waiting on a fixed share
+    m_threadPool.parallelForEach(static_cast<std::size_t>(count), [this, firstSoup](std::size_t index, std::size_t thread)
+                                 {
+                                     this->runSoup(*m_workers[thread], firstSoup + index);
+                                 });
+
+    SoupSearchResult total;
+    for (auto& worker : m_workers)
+    {
+        total.merge(worker->result);
+    }
+    return total;
+}
+
+std::uint64_t SoupSearch::getSoupSeed(std::uint64_t seed, std::uint64_t soup)
+{
+    // splitmix64 of the soup number, so neighbouring soups get unrelated generators
+    std::uint64_t value = seed + (soup + 1) * 0x9e3779b97f4a7c15;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111eb;
+    return value ^ (value >> 31);
+}
+
+void SoupSearch::runSoup(Worker& worker, std::uint64_t soup) const
+{
+    std::mt19937_64 engine(getSoupSeed(m_options.seed, soup));
+    std::bernoulli_distribution alive(m_options.density);
+    for (std::uint32_t y = 0; y < m_options.soupSize; y++)
+    {
+        for (std::uint32_t x = 0; x < m_options.soupSize; x++)
+        {
+            worker.soup.setCell(x, y, alive(engine));
+        }
+    }
+
+    std::uint32_t start = (m_options.boardSize - m_options.soupSize) / 2;
+    worker.simulation.clear();
+    worker.simulation.insertPattern(worker.soup, start, start);
+
+    SoupSearchResult& result = worker.result;
+    result.soups++;
+    result.generations += worker.simulation.stepUntilStable(m_options.maxGenerations);
+    if (!worker.simulation.isStable())
+    {
+        return;
+    }
+
+    result.stabilized++;
+    result.periods[std::min(worker.simulation.detectedPeriod(), result.periods.size() - 1)]++;
+    result.objects += countObjects(worker.simulation, result.objectSizes);
+    result.population += worker.simulation.population();
+}
+
+std::size_t SoupSearch::countObjects(const LifeSimulator& simulation, std::vector<std::uint64_t>& sizes)
+{
+    // Flood fill over a copy of the board, clearing each cell as it is reached
+    std::size_t wordsPerRow = simulation.getWordsPerRow();
+    std::vector<std::uint64_t> cells(wordsPerRow * simulation.getSizeY());
+    for (std::uint32_t y = 0; y < simulation.getSizeY(); y++)
+    {
+        std::copy(simulation.getRow(y), simulation.getRow(y) + wordsPerRow, cells.begin() + y * wordsPerRow);
+    }
+
+    auto takeCell = [&](std::int64_t x, std::int64_t y)
+    {
+        if (x < 0 || y < 0 || x >= simulation.getSizeX() || y >= simulation.getSizeY())
+        {
+            return false;
+        }
+        std::uint64_t& word = cells[static_cast<std::size_t>(y) * wordsPerRow + static_cast<std::size_t>(x) / 64];
+        std::uint64_t bit = std::uint64_t{ 1 } << (x % 64);
+        bool alive = (word & bit) != 0;
+        word &= ~bit;
+        return alive;
+    };
+
+    std::size_t objects = 0;
+    std::vector<std::pair<std::int64_t, std::int64_t>> pending;
+    for (std::size_t index = 0; index < cells.size(); index++)
+    {
+        while (cells[index] != 0)
+        {
+            std::int64_t x = static_cast<std::int64_t>((index % wordsPerRow) * 64 + std::countr_zero(cells[index]));
+            std::int64_t y = static_cast<std::int64_t>(index / wordsPerRow);
+            std::size_t size = 0;
+
+            takeCell(x, y);
+            pending.emplace_back(x, y);
+            while (!pending.empty())
+            {
+                auto [cellX, cellY] = pending.back();
+                pending.pop_back();
+                size++;
+                for (std::int64_t dy = -1; dy <= 1; dy++)
+                {
+                    for (std::int64_t dx = -1; dx <= 1; dx++)
+                    {
+                        if (takeCell(cellX + dx, cellY + dy))
+                        {
+                            pending.emplace_back(cellX + dx, cellY + dy);
+                        }
+                    }
+                }
+            }
+
+            sizes[std::min(size, sizes.size() - 1)]++;
+            objects++;
+        }
+    }
+    return objects;
+}
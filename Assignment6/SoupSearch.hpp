@@ -0,0 +1,78 @@
+#pragma once
+#include "LifeRule.hpp"
+#include "LifeSimulator.hpp"
+#include "PatternBitmap.hpp"
+#include "ThreadPool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class SoupSearchOptions
+{
+  public:
+    // Soups are random squares of this size in the middle of a larger dead board, so the debris
+    // has room to spread before it reaches the edge
+    std::uint32_t soupSize = 16;
+    std::uint32_t boardSize = 128;
+    double density = 0.5;
+    std::size_t maxGenerations = 5000;
+    std::uint64_t seed = 1;
+    std::size_t threads = 1;
+    LifeRule rule;
+};
+
+// Totals over a batch of soups; every count is a sum, so partial results can be merged in any order
+class SoupSearchResult
+{
+  public:
+    std::uint64_t soups = 0;
+    // Soups that reached a still life or an oscillator within the generation limit
+    std::uint64_t stabilized = 0;
+    std::uint64_t generations = 0;
+    // Live cells and 8-connected groups of live cells left by the stabilized soups
+    std::uint64_t population = 0;
+    std::uint64_t objects = 0;
+    // Stabilized soups by the period of the final board, 1 for still lifes
+    std::vector<std::uint64_t> periods = std::vector<std::uint64_t>(LifeSimulator::HASH_HISTORY + 1, 0);
+    // Objects by their number of cells, the last entry counting every larger object
+    std::vector<std::uint64_t> objectSizes = std::vector<std::uint64_t>(33, 0);
+
+    void merge(const SoupSearchResult& other);
+};
+
+// Runs batches of independent soups on a work-stealing thread pool. Each thread owns one
+// simulator that is cleared and reused for every soup it takes, and its own result that is only
+// merged with the others once the batch is done, so the threads never share a lock.
+class SoupSearch
+{
+  public:
+    SoupSearch(const SoupSearchOptions& options);
+
+    // Runs soups firstSoup to firstSoup + count - 1. Soup n is the same board for a given seed
+    // whatever the batch or thread count, so results are reproducible and batches can be split up.
+    SoupSearchResult run(std::uint64_t firstSoup, std::uint64_t count);
+
+    static std::uint64_t getSoupSeed(std::uint64_t seed, std::uint64_t soup);
+    // Counts the 8-connected groups of live cells, adding the size of each one to `sizes`
+    static std::size_t countObjects(const LifeSimulator& simulation, std::vector<std::uint64_t>& sizes);
+
+  private:
+    // Everything one thread touches while running a soup, on its own cache lines
+    class alignas(64) Worker
+    {
+      public:
+        Worker(const SoupSearchOptions& options);
+
+        LifeSimulator simulation;
+        PatternBitmap soup;
+        SoupSearchResult result;
+    };
+
+    SoupSearchOptions m_options;
+    ThreadPool m_threadPool;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    void runSoup(Worker& worker, std::uint64_t soup) const;
+};
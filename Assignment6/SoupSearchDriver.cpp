@@ -0,0 +1,144 @@
+#include "LifeRule.hpp"
+#include "SoupSearch.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+    const char* USAGE =
+        "Usage: LifeSoupSearch [options]\n"
+        "  --soups N              soups to run, 10000 by default\n"
+        "  --first N              number of the first soup, 0 by default\n"
+        "  --seed N               seed every soup is derived from, 1 by default\n"
+        "  --soup-size N          edge length of the random square, 16 by default\n"
+        "  --board-size N         edge length of the dead board around it, 128 by default\n"
+        "  --density D            live fraction of the soup, 0.5 by default\n"
+        "  --max-generations N    generations before a soup counts as unfinished, 5000 by default\n"
+        "  --threads N            worker threads, one per core by default\n"
+        "  --rule B3/S23          rule to simulate\n";
+
+    template <typename T>
+    T parseValue(const std::string& option, const std::string& text)
+    {
+        std::istringstream input(text);
+        T value;
+        if (!(input >> value) || !input.eof())
+        {
+            throw std::invalid_argument("Cannot read '" + text + "' for " + option);
+        }
+        return value;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SoupSearchOptions options;
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t soups = 10000;
+    std::uint64_t first = 0;
+
+    try
+    {
+        for (int i = 1; i < argc; i += 2)
+        {
+            std::string option = argv[i];
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+
+            std::string value = argv[i + 1];
+            if (option == "--soups")
+            {
+                soups = parseValue<std::uint64_t>(option, value);
+            }
+            else if (option == "--first")
+            {
+                first = parseValue<std::uint64_t>(option, value);
+            }
+            else if (option == "--seed")
+            {
+                options.seed = parseValue<std::uint64_t>(option, value);
+            }
+            else if (option == "--soup-size")
+            {
+                options.soupSize = parseValue<std::uint32_t>(option, value);
+            }
+            else if (option == "--board-size")
+            {
+                options.boardSize = parseValue<std::uint32_t>(option, value);
+            }
+            else if (option == "--density")
+            {
+                options.density = parseValue<double>(option, value);
+            }
+            else if (option == "--max-generations")
+            {
+                options.maxGenerations = parseValue<std::size_t>(option, value);
+            }
+            else if (option == "--threads")
+            {
+                options.threads = std::max<std::size_t>(1, parseValue<std::size_t>(option, value));
+            }
+            else if (option == "--rule")
+            {
+                options.rule = LifeRule(value);
+            }
+            else
+            {
+                throw std::invalid_argument("Unknown option " + option);
+            }
+        }
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cerr << error.what() << "\n"
+                  << USAGE;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    SoupSearchResult result;
+    try
+    {
+        SoupSearch search(options);
+        result = search.run(first, soups);
+    }
+    catch (const std::invalid_argument& error)
+    {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "rule " << options.rule.toString() << ", seed " << options.seed << ", soups " << first << " to " << first + soups << "\n"
+              << "soups " << result.soups << ", stabilized " << result.stabilized << ", unfinished " << result.soups - result.stabilized << "\n"
+              << "generations " << result.generations << ", population " << result.population << ", objects " << result.objects << "\n"
+              << "seconds " << elapsed.count() << ", soups per second " << static_cast<double>(result.soups) / std::max(elapsed.count(), 1e-9) << "\n";
+
+    std::cout << "period,soups\n";
+    for (std::size_t period = 1; period < result.periods.size(); period++)
+    {
+        if (result.periods[period] != 0)
+        {
+            std::cout << period << ',' << result.periods[period] << '\n';
+        }
+    }
+    std::cout << "object_cells,objects\n";
+    for (std::size_t size = 1; size < result.objectSizes.size(); size++)
+    {
+        if (result.objectSizes[size] != 0)
+        {
+            std::cout << size << (size + 1 == result.objectSizes.size() ? "+" : "") << ',' << result.objectSizes[size] << '\n';
+        }
+    }
+
+    return 0;
+}
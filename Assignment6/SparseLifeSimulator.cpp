@@ -0,0 +1,287 @@
+#include "SparseLifeSimulator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace
+{
+    // Presents a window of the universe as a pattern so it can be inserted into a LifeSimulator
+    class PatternViewport : public Pattern
+    {
+      public:
+        PatternViewport(const SparseLifeSimulator& universe, std::int64_t originX, std::int64_t originY, std::uint32_t sizeX, std::uint32_t sizeY) :
+            m_universe(universe),
+            m_originX(originX),
+            m_originY(originY),
+            m_sizeX(sizeX),
+            m_sizeY(sizeY)
+        {
+        }
+
+        std::uint32_t getSizeX() const override { return m_sizeX; }
+        std::uint32_t getSizeY() const override { return m_sizeY; }
+        bool getCell(std::uint32_t x, std::uint32_t y) const override { return m_universe.getCell(m_originX + x, m_originY + y); }
+
+      private:
+        const SparseLifeSimulator& m_universe;
+        std::int64_t m_originX;
+        std::int64_t m_originY;
+        std::uint32_t m_sizeX;
+        std::uint32_t m_sizeY;
+    };
+}
+
+SparseLifeSimulator::SparseLifeSimulator(const LifeRule& rule) :
+    m_kernelRule(rule.getBirthCounts(), rule.getSurvivalCounts())
+{
+    if (rule.isBorn(0))
+    {
+        throw std::invalid_argument("An unbounded universe cannot use B0 rule " + rule.toString());
+    }
+    if (rule.getStates() > 2)
+    {
+        throw std::invalid_argument("Generations rule " + rule.toString() + " needs LifeSimulator");
+    }
+    m_rowKernel = getLifeRowKernel(detectLifeKernel(), m_kernelRule);
+    m_padded.fill(0);
+    m_changes.fill(0);
+}
+
+void SparseLifeSimulator::insertPattern(const Pattern& pattern, std::int64_t startX, std::int64_t startY)
+{
+    for (std::uint32_t y = 0; y < pattern.getSizeY(); y++)
+    {
+        for (std::uint32_t x = 0; x < pattern.getSizeX(); x++)
+        {
+            this->setCell(startX + x, startY + y, pattern.getCell(x, y));
+        }
+    }
+}
+
+void SparseLifeSimulator::update()
+{
+    this->step(1);
+}
+
+void SparseLifeSimulator::step(std::size_t generations)
+{
+    for (std::size_t generation = 0; generation < generations; generation++)
+    {
+        this->createBorderChunks();
+
+        for (auto& [key, chunk] : m_chunks)
+        {
+            this->computeChunk(key.x, key.y, *chunk);
+        }
+
+        m_population = 0;
+        for (auto iterator = m_chunks.begin(); iterator != m_chunks.end();)
+        {
+            Chunk& chunk = *iterator->second;
+            chunk.cells.swap(chunk.next);
+
+            std::uint64_t population = 0;
+            for (auto word : chunk.cells)
+            {
+                population += std::popcount(word);
+            }
+
+            if (population == 0)
+            {
+                m_spareChunks.push_back(std::move(iterator->second));
+                iterator = m_chunks.erase(iterator);
+            }
+            else
+            {
+                m_population += population;
+                ++iterator;
+            }
+        }
+    }
+}
+
+bool SparseLifeSimulator::getCell(std::int64_t x, std::int64_t y) const
+{
+    // Shifting rounds negative coordinates down, so cells left of zero land in chunk -1
+    const Chunk* chunk = findChunk(x >> CHUNK_SHIFT_X, y >> CHUNK_SHIFT_Y);
+    if (chunk == nullptr)
+    {
+        return false;
+    }
+
+    std::int64_t localX = x & ((1 << CHUNK_SHIFT_X) - 1);
+    std::int64_t localY = y & ((1 << CHUNK_SHIFT_Y) - 1);
+    return (chunk->cells[localY * CHUNK_WORDS + localX / 64] >> (localX % 64)) & 1;
+}
+
+std::uint64_t SparseLifeSimulator::getPopulation() const
+{
+    return m_population;
+}
+
+std::size_t SparseLifeSimulator::getChunkCount() const
+{
+    return m_chunks.size();
+}
+
+void SparseLifeSimulator::copyViewport(LifeSimulator& viewport, std::int64_t originX, std::int64_t originY) const
+{
+    viewport.insertPattern(PatternViewport(*this, originX, originY, viewport.getSizeX(), viewport.getSizeY()), 0, 0);
+}
+
+std::size_t SparseLifeSimulator::ChunkKeyHash::operator()(const ChunkKey& key) const
+{
+    // Both full coordinates go into the hash, so chunks far apart never share a key
+    std::uint64_t hash = static_cast<std::uint64_t>(key.x) * 0x9e3779b97f4a7c15ull;
+    hash = std::rotl(hash, 31) ^ static_cast<std::uint64_t>(key.y);
+    hash *= 0xbf58476d1ce4e5b9ull;
+    return static_cast<std::size_t>(hash ^ (hash >> 29));
+}
+
+const SparseLifeSimulator::Chunk* SparseLifeSimulator::findChunk(std::int64_t chunkX, std::int64_t chunkY) const
+{
+    auto found = m_chunks.find({ chunkX, chunkY });
+    return found == m_chunks.end() ? nullptr : found->second.get();
+}
+
+SparseLifeSimulator::Chunk& SparseLifeSimulator::getOrCreateChunk(std::int64_t chunkX, std::int64_t chunkY)
+{
+    auto& chunk = m_chunks[{ chunkX, chunkY }];
+
+    if (!chunk)
+    {
+        if (m_spareChunks.empty())
+        {
+            chunk = std::make_unique<Chunk>();
+        }
+        else
+        {
+            chunk = std::move(m_spareChunks.back());
+            m_spareChunks.pop_back();
+        }
+        chunk->cells.fill(0);
+    }
+    return *chunk;
+}
+
+void SparseLifeSimulator::setCell(std::int64_t x, std::int64_t y, bool value)
+{
+    if (!value && findChunk(x >> CHUNK_SHIFT_X, y >> CHUNK_SHIFT_Y) == nullptr)
+    {
+        return;
+    }
+
+    Chunk& chunk = getOrCreateChunk(x >> CHUNK_SHIFT_X, y >> CHUNK_SHIFT_Y);
+    std::int64_t localX = x & ((1 << CHUNK_SHIFT_X) - 1);
+    std::int64_t localY = y & ((1 << CHUNK_SHIFT_Y) - 1);
+    std::uint64_t bit = std::uint64_t{ 1 } << (localX % 64);
+    std::uint64_t& word = chunk.cells[localY * CHUNK_WORDS + localX / 64];
+
+    if (((word & bit) != 0) != value)
+    {
+        word ^= bit;
+        if (value)
+        {
+            m_population++;
+        }
+        else
+        {
+            m_population--;
+        }
+    }
+}
+
+void SparseLifeSimulator::createBorderChunks()
+{
+    // Cells can only be born next to live cells, so a chunk is needed wherever a live cell
+    // touches the edge of a chunk that does not exist yet
+    m_scratchKeys.clear();
+    for (auto& [key, chunk] : m_chunks)
+    {
+        std::int64_t chunkX = key.x;
+        std::int64_t chunkY = key.y;
+        const auto& cells = chunk->cells;
+
+        std::uint64_t top = 0;
+        std::uint64_t bottom = 0;
+        for (std::size_t word = 0; word < CHUNK_WORDS; word++)
+        {
+            top |= cells[word];
+            bottom |= cells[(CHUNK_ROWS - 1) * CHUNK_WORDS + word];
+        }
+
+        std::uint64_t left = 0;
+        std::uint64_t right = 0;
+        for (std::size_t row = 0; row < CHUNK_ROWS; row++)
+        {
+            left |= cells[row * CHUNK_WORDS] & 1;
+            right |= cells[row * CHUNK_WORDS + CHUNK_WORDS - 1] >> 63;
+        }
+
+        bool topLeft = cells[0] & 1;
+        bool topRight = cells[CHUNK_WORDS - 1] >> 63;
+        bool bottomLeft = cells[(CHUNK_ROWS - 1) * CHUNK_WORDS] & 1;
+        bool bottomRight = cells[CHUNK_ROWS * CHUNK_WORDS - 1] >> 63;
+
+        std::array<std::array<bool, 3>, 3> needed = { { { topLeft, top != 0, topRight },
+                                                        { left != 0, false, right != 0 },
+                                                        { bottomLeft, bottom != 0, bottomRight } } };
+        for (std::int64_t dy = -1; dy <= 1; dy++)
+        {
+            for (std::int64_t dx = -1; dx <= 1; dx++)
+            {
+                if (needed[dy + 1][dx + 1] && findChunk(chunkX + dx, chunkY + dy) == nullptr)
+                {
+                    m_scratchKeys.push_back({ chunkX + dx, chunkY + dy });
+                }
+            }
+        }
+    }
+
+    for (auto key : m_scratchKeys)
+    {
+        getOrCreateChunk(key.x, key.y);
+    }
+}
+
+void SparseLifeSimulator::computeChunk(std::int64_t chunkX, std::int64_t chunkY, Chunk& chunk)
+{
+    const std::size_t stride = CHUNK_WORDS + 2;
+    std::array<std::array<const Chunk*, 3>, 3> neighbours;
+
+    for (std::int64_t dy = -1; dy <= 1; dy++)
+    {
+        for (std::int64_t dx = -1; dx <= 1; dx++)
+        {
+            neighbours[dy + 1][dx + 1] = findChunk(chunkX + dx, chunkY + dy);
+        }
+    }
+
+    // Gather the chunk plus the last row above, the first row below and the edge words either side
+    for (std::size_t row = 0; row < CHUNK_ROWS + 2; row++)
+    {
+        std::size_t band = (row == 0) ? 0 : (row == CHUNK_ROWS + 1) ? 2 : 1;
+        std::size_t sourceRow = (row == 0) ? CHUNK_ROWS - 1 : (row == CHUNK_ROWS + 1) ? 0 : row - 1;
+        const Chunk* west = neighbours[band][0];
+        const Chunk* centre = neighbours[band][1];
+        const Chunk* east = neighbours[band][2];
+        std::uint64_t* padded = &m_padded[row * stride];
+
+        padded[0] = west ? west->cells[sourceRow * CHUNK_WORDS + CHUNK_WORDS - 1] : 0;
+        for (std::size_t word = 0; word < CHUNK_WORDS; word++)
+        {
+            padded[word + 1] = centre ? centre->cells[sourceRow * CHUNK_WORDS + word] : 0;
+        }
+        padded[CHUNK_WORDS + 1] = east ? east->cells[sourceRow * CHUNK_WORDS] : 0;
+    }
+
+    // The change mask is only needed by LifeSimulator's tile tracking and is ignored here
+    for (std::size_t row = 0; row < CHUNK_ROWS; row++)
+    {
+        const std::uint64_t* mid = &m_padded[(row + 1) * stride + 1];
+        m_rowKernel(mid - stride, mid, mid + stride, &chunk.next[row * CHUNK_WORDS], m_changes.data(), CHUNK_WORDS, m_kernelRule);
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "LifeKernel.hpp"
+#include "LifeRule.hpp"
+#include "LifeSimulator.hpp"
+#include "Pattern.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Unbounded Life universe made of fixed-size chunks kept in a hash map. A chunk is created when
+// cells could be born in it and freed as soon as it is empty, so memory follows the population.
+// Chunks are keyed by their full 64-bit coordinates, so distant chunks never collide.
+class SparseLifeSimulator
+{
+  public:
+    // Rules with B0 fill infinite space in one generation and throw std::invalid_argument, as do
+    // Generations rules
+    SparseLifeSimulator(const LifeRule& rule = LifeRule());
+
+    void insertPattern(const Pattern& pattern, std::int64_t startX, std::int64_t startY);
+    void update();
+    void step(std::size_t generations);
+
+    bool getCell(std::int64_t x, std::int64_t y) const;
+    std::uint64_t getPopulation() const;
+    std::size_t getChunkCount() const;
+
+    // Copies the window whose top left corner is (originX, originY) onto the whole board of
+    // `viewport`, so any Renderer can draw part of the universe
+    void copyViewport(LifeSimulator& viewport, std::int64_t originX, std::int64_t originY) const;
+
+  private:
+    // A chunk is 256 cells (four words) wide and 64 rows tall
+    static constexpr int CHUNK_SHIFT_X = 8;
+    static constexpr int CHUNK_SHIFT_Y = 6;
+    static constexpr std::size_t CHUNK_WORDS = (1 << CHUNK_SHIFT_X) / 64;
+    static constexpr std::size_t CHUNK_ROWS = 1 << CHUNK_SHIFT_Y;
+
+    class Chunk
+    {
+      public:
+        std::array<std::uint64_t, CHUNK_WORDS * CHUNK_ROWS> cells;
+        std::array<std::uint64_t, CHUNK_WORDS * CHUNK_ROWS> next;
+    };
+
+    // Chunk coordinates, the cell coordinates shifted down by CHUNK_SHIFT_X and CHUNK_SHIFT_Y
+    class ChunkKey
+    {
+      public:
+        std::int64_t x;
+        std::int64_t y;
+
+        bool operator==(const ChunkKey& other) const = default;
+    };
+    class ChunkKeyHash
+    {
+      public:
+        std::size_t operator()(const ChunkKey& key) const;
+    };
+
+    std::unordered_map<ChunkKey, std::unique_ptr<Chunk>, ChunkKeyHash> m_chunks;
+    // Freed chunks are kept for reuse so gliders moving through space do not churn the allocator
+    std::vector<std::unique_ptr<Chunk>> m_spareChunks;
+    std::vector<ChunkKey> m_scratchKeys;
+    // One chunk with a border of neighbour cells around it, as the row kernel expects
+    std::array<std::uint64_t, (CHUNK_WORDS + 2) * (CHUNK_ROWS + 2)> m_padded;
+    std::array<std::uint64_t, CHUNK_WORDS> m_changes;
+    LifeKernelRule m_kernelRule;
+    LifeRowKernel m_rowKernel;
+    std::uint64_t m_population = 0;
+
+    const Chunk* findChunk(std::int64_t chunkX, std::int64_t chunkY) const;
+    Chunk& getOrCreateChunk(std::int64_t chunkX, std::int64_t chunkY);
+    void setCell(std::int64_t x, std::int64_t y, bool value);
+    void createBorderChunks();
+    void computeChunk(std::int64_t chunkX, std::int64_t chunkY, Chunk& chunk);
+};
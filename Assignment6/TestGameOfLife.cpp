@@ -1,15 +1,40 @@
+#include "HashLife.hpp"
+#include "LifeBoundary.hpp"
+#include "LifeFrame.hpp"
+#include "LifeFrameSlot.hpp"
+#include "LifeKernel.hpp"
+#include "LifeRule.hpp"
 #include "LifeSimulator.hpp"
 #include "Pattern.hpp"
 #include "PatternAcorn.hpp"
+#include "PatternBitmap.hpp"
 #include "PatternBlinker.hpp"
 #include "PatternBlock.hpp"
 #include "PatternGlider.hpp"
 #include "PatternGosperGliderGun.hpp"
 #include "PatternPulsar.hpp"
-
+#include "RendererConsole.hpp"
+#include "RendererImage.hpp"
+#include "SnapshotFile.hpp"
+#include "SnapshotWriter.hpp"
+#include "SoupSearch.hpp"
+#include "SparseLifeSimulator.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
 #include <vector>
 
 int main(int argc, char* argv[])
@@ -23,9 +48,9 @@ using State = std::vector<std::vector<bool>>;
 class PatternTestToad : public Pattern
 {
   public:
-    virtual std::uint8_t getSizeX() const override { return static_cast<std::uint8_t>(m_sizeX); }
-    virtual std::uint8_t getSizeY() const override { return static_cast<std::uint8_t>(m_sizeY); }
-    virtual bool getCell(std::uint8_t x, std::uint8_t y) const override
+    virtual std::uint32_t getSizeX() const override { return static_cast<std::uint32_t>(m_sizeX); }
+    virtual std::uint32_t getSizeY() const override { return static_cast<std::uint32_t>(m_sizeY); }
+    virtual bool getCell(std::uint32_t x, std::uint32_t y) const override
     {
         if (x > m_sizeX - 1 || y > m_sizeY - 1)
         {
@@ -39,16 +64,16 @@ class PatternTestToad : public Pattern
         { { false, true, true, true },
           { true, true, true, false } }
     };
-    const std::uint8_t m_sizeX = 4;
-    const std::uint8_t m_sizeY = 2;
+    const std::uint32_t m_sizeX = 4;
+    const std::uint32_t m_sizeY = 2;
 };
 
 class PatternOneByOne : public Pattern
 {
   public:
-    virtual std::uint8_t getSizeX() const override { return static_cast<std::uint8_t>(m_sizeX); }
-    virtual std::uint8_t getSizeY() const override { return static_cast<std::uint8_t>(m_sizeY); }
-    virtual bool getCell(std::uint8_t x, std::uint8_t y) const override
+    virtual std::uint32_t getSizeX() const override { return static_cast<std::uint32_t>(m_sizeX); }
+    virtual std::uint32_t getSizeY() const override { return static_cast<std::uint32_t>(m_sizeY); }
+    virtual bool getCell(std::uint32_t x, std::uint32_t y) const override
     {
         if (x > m_sizeX - 1 || y > m_sizeY - 1)
         {
@@ -61,15 +86,94 @@ class PatternOneByOne : public Pattern
     const std::array<std::array<bool, 1>, 1> m_data = {
         { { true } }
     };
-    const std::uint8_t m_sizeX = 1;
-    const std::uint8_t m_sizeY = 1;
+    const std::uint32_t m_sizeX = 1;
+    const std::uint32_t m_sizeY = 1;
 };
 
+class PatternState : public Pattern
+{
+  public:
+    PatternState(const State& state) :
+        m_state(state)
+    {
+    }
+    virtual std::uint32_t getSizeX() const override { return static_cast<std::uint32_t>(m_state[0].size()); }
+    virtual std::uint32_t getSizeY() const override { return static_cast<std::uint32_t>(m_state.size()); }
+    virtual bool getCell(std::uint32_t x, std::uint32_t y) const override { return m_state[y][x]; }
+
+  private:
+    const State& m_state;
+};
+
+State randomState(std::size_t sizeX, std::size_t sizeY, unsigned int seed)
+{
+    std::mt19937 engine(seed);
+    std::bernoulli_distribution alive(0.35);
+    State state(sizeY, std::vector<bool>(sizeX, false));
+
+    for (auto& row : state)
+    {
+        for (std::size_t x = 0; x < sizeX; x++)
+        {
+            row[x] = alive(engine);
+        }
+    }
+    return state;
+}
+
+// Maps a coordinate one step past the edge back onto the board; -1 when the cell is dead
+int boundaryCoordinate(int position, int size, LifeBoundary boundary)
+{
+    if (position >= 0 && position < size)
+    {
+        return position;
+    }
+    switch (boundary)
+    {
+        case LifeBoundary::Torus:
+            return (position + size) % size;
+        case LifeBoundary::Mirror:
+            return position < 0 ? 0 : size - 1;
+        default:
+            return -1;
+    }
+}
+
+// Straightforward per-cell reference used as the oracle for the packed simulator
+State referenceUpdate(const State& state, const LifeRule& rule = LifeRule(), LifeBoundary boundary = LifeBoundary::Dead)
+{
+    const int sizeY = static_cast<int>(state.size());
+    const int sizeX = static_cast<int>(state[0].size());
+    State updated(sizeY, std::vector<bool>(sizeX, false));
+
+    for (int y = 0; y < sizeY; y++)
+    {
+        for (int x = 0; x < sizeX; x++)
+        {
+            int count = 0;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int nx = boundaryCoordinate(x + dx, sizeX, boundary);
+                    int ny = boundaryCoordinate(y + dy, sizeY, boundary);
+                    if ((dx != 0 || dy != 0) && nx >= 0 && ny >= 0 && state[ny][nx])
+                    {
+                        count++;
+                    }
+                }
+            }
+            updated[y][x] = state[y][x] ? rule.survives(count) : rule.isBorn(count);
+        }
+    }
+    return updated;
+}
+
 void compareStates(const LifeSimulator& simulation, const State& update, const int& updateNum)
 {
-    for (std::uint8_t y = 0; y < update.size(); y++)
+    for (std::uint32_t y = 0; y < update.size(); y++)
     {
-        for (std::uint8_t x = 0; x < update[y].size(); x++)
+        for (std::uint32_t x = 0; x < update[y].size(); x++)
         {
             EXPECT_EQ(update[y][x], simulation.getCell(x, y))
                 << "Wrong cell state at ("
@@ -86,9 +190,9 @@ TEST(LifeSimulator_Constructor, InitialStateDead)
 {
     LifeSimulator simulation = LifeSimulator(3, 3);
 
-    for (std::uint8_t y = 0; y < simulation.getSizeY(); y++)
+    for (std::uint32_t y = 0; y < simulation.getSizeY(); y++)
     {
-        for (std::uint8_t x = 0; x < simulation.getSizeX(); x++)
+        for (std::uint32_t x = 0; x < simulation.getSizeX(); x++)
         {
             EXPECT_FALSE(simulation.getCell(x, y))
                 << "Cell alive at ("
@@ -125,6 +229,31 @@ TEST(LifeSimulator_InsertPattern, CanInsertArbitraryPattern)
     compareStates(simulation, insertState, 0);
 }
 
+TEST(LifeSimulator_InsertPattern, BoardLargerThanEightBitCoordinates)
+{
+    LifeSimulator simulation = LifeSimulator(1000, 300);
+
+    EXPECT_EQ(1000, simulation.getSizeX());
+    EXPECT_EQ(300, simulation.getSizeY());
+
+    simulation.insertPattern(PatternGlider(), 600, 280);
+    simulation.insertPattern(PatternOneByOne(), 999, 299);
+    simulation.insertPattern(PatternTestToad(), 998, 299);
+
+    EXPECT_TRUE(simulation.getCell(602, 280));
+    EXPECT_TRUE(simulation.getCell(601, 282));
+    EXPECT_TRUE(simulation.getCell(999, 299));
+    EXPECT_FALSE(simulation.getCell(998, 299));
+    EXPECT_FALSE(simulation.getCell(1000, 299));
+
+    simulation.step(4);
+
+    // A glider moves one cell diagonally every four generations
+    EXPECT_TRUE(simulation.getCell(603, 281));
+    EXPECT_TRUE(simulation.getCell(602, 283));
+    EXPECT_FALSE(simulation.getCell(602, 280));
+}
+
 TEST(LifeSimulator_InsertPattern, OutOfBoundsHandled)
 {
     LifeSimulator simulation = LifeSimulator(4, 4);
@@ -141,6 +270,46 @@ TEST(LifeSimulator_InsertPattern, OutOfBoundsHandled)
     compareStates(simulation, successfulInsert, 0);
 }
 
+TEST(LifeSimulator_InsertPattern, PackedRowsMatchCellByCell)
+{
+    // Widths and offsets that leave partial words on both sides, some of it past the board edge
+    State state = randomState(200, 40, 3);
+    PatternBitmap packed(200, 40);
+    for (std::uint32_t y = 0; y < 40; y++)
+    {
+        for (std::uint32_t x = 0; x < 200; x++)
+        {
+            packed.setCell(x, y, state[y][x]);
+        }
+    }
+
+    for (std::uint32_t startX : { 0, 37, 64, 130 })
+    {
+        LifeSimulator expected = LifeSimulator(300, 60);
+        LifeSimulator simulation = LifeSimulator(300, 60);
+        expected.insertPattern(PatternState(randomState(300, 60, 4)), 0, 0);
+        simulation.insertPattern(PatternState(randomState(300, 60, 4)), 0, 0);
+        expected.step(1);
+        simulation.step(1);
+
+        expected.insertPattern(PatternState(state), startX, 25);
+        simulation.insertPattern(packed, startX, 25);
+
+        for (int update = 0; update <= 2; update++)
+        {
+            for (std::uint32_t y = 0; y < 60; y++)
+            {
+                for (std::uint32_t x = 0; x < 300; x++)
+                {
+                    ASSERT_EQ(expected.getCell(x, y), simulation.getCell(x, y)) << "Wrong cell state at (" << x << ", " << y << ") inserted at " << startX;
+                }
+            }
+            expected.update();
+            simulation.update();
+        }
+    }
+}
+
 TEST(LifeSimulator_Update, Underpopulation)
 {
     LifeSimulator simulation = LifeSimulator(4, 4);
@@ -233,6 +402,543 @@ TEST(LifeSimulator_Update, OutOfBoundsCellsAreDead)
     compareStates(simulation, updated, 1);
 }
 
+TEST(LifeSimulator_Update, MatchesReferenceAcrossWordBoundaries)
+{
+    State state = randomState(150, 40, 3460);
+    LifeSimulator simulation = LifeSimulator(150, 40);
+
+    simulation.insertPattern(PatternState(state), 0, 0);
+
+    for (int update = 1; update <= 20; update++)
+    {
+        simulation.update();
+        state = referenceUpdate(state);
+        compareStates(simulation, state, update);
+    }
+}
+
+TEST(LifeSimulator_Step, MatchesRepeatedUpdates)
+{
+    State state = randomState(70, 30, 6);
+    LifeSimulator stepped = LifeSimulator(70, 30);
+    LifeSimulator updated = LifeSimulator(70, 30);
+
+    stepped.insertPattern(PatternState(state), 0, 0);
+    updated.insertPattern(PatternState(state), 0, 0);
+
+    stepped.step(0);
+    compareStates(stepped, state, 0);
+
+    stepped.step(25);
+    for (int update = 1; update <= 25; update++)
+    {
+        updated.update();
+        state = referenceUpdate(state);
+    }
+
+    compareStates(stepped, state, 25);
+    compareStates(updated, state, 25);
+}
+
+TEST(LifeSimulator_Step, ParallelMatchesSerial)
+{
+    State state = randomState(300, 157, 42);
+    LifeSimulator serial = LifeSimulator(300, 157);
+    LifeSimulator parallel = LifeSimulator(300, 157);
+
+    parallel.setThreadCount(4);
+    EXPECT_EQ(4, parallel.getThreadCount());
+
+    serial.insertPattern(PatternState(state), 0, 0);
+    parallel.insertPattern(PatternState(state), 0, 0);
+
+    for (int update = 1; update <= 30; update++)
+    {
+        serial.update();
+        parallel.update();
+        state = referenceUpdate(state);
+    }
+
+    compareStates(serial, state, 30);
+    compareStates(parallel, state, 30);
+
+    parallel.setThreadCount(1);
+    EXPECT_EQ(1, parallel.getThreadCount());
+}
+
+TEST(LifeSimulator_Step, EveryKernelMatchesReference)
+{
+    for (auto kernel : { LifeKernelType::Scalar, LifeKernelType::Sse2, LifeKernelType::Avx2 })
+    {
+        if (!isLifeKernelSupported(kernel))
+        {
+            continue;
+        }
+
+        // 450 columns leaves a partial word and a partial SIMD block at the end of every row
+        State state = randomState(450, 60, 7);
+        LifeSimulator simulation = LifeSimulator(450, 60);
+        simulation.setKernel(kernel);
+        EXPECT_EQ(kernel, simulation.getKernel());
+
+        simulation.insertPattern(PatternState(state), 0, 0);
+
+        for (int update = 1; update <= 10; update++)
+        {
+            simulation.update();
+            state = referenceUpdate(state);
+        }
+        compareStates(simulation, state, 10);
+    }
+}
+
+TEST(LifeSimulator_Rule, EveryKernelMatchesReferenceForOtherRules)
+{
+    // HighLife, Day & Night, Seeds, and a B0 rule that brings empty space to life
+    for (auto notation : { "B36/S23", "B3678/S34678", "B2/S", "B0/S8" })
+    {
+        for (auto kernel : { LifeKernelType::Scalar, LifeKernelType::Sse2, LifeKernelType::Avx2 })
+        {
+            if (!isLifeKernelSupported(kernel))
+            {
+                continue;
+            }
+
+            LifeRule rule(notation);
+            State state = randomState(450, 60, 11);
+            LifeSimulator simulation = LifeSimulator(450, 60, rule);
+            simulation.setKernel(kernel);
+            EXPECT_EQ(rule, simulation.getRule());
+
+            simulation.insertPattern(PatternState(state), 0, 0);
+
+            for (int update = 1; update <= 10; update++)
+            {
+                simulation.update();
+                state = referenceUpdate(state, rule);
+            }
+            compareStates(simulation, state, 10);
+        }
+    }
+}
+
+TEST(LifeSimulator_Boundary, EveryKernelMatchesReferenceAtTheEdges)
+{
+    // One board ends inside a word, the other fills its last word exactly
+    for (auto [sizeX, sizeY] : { std::pair{ 70u, 37u }, std::pair{ 256u, 40u } })
+    {
+        for (auto boundary : { LifeBoundary::Torus, LifeBoundary::Mirror })
+        {
+            for (auto kernel : { LifeKernelType::Scalar, LifeKernelType::Sse2, LifeKernelType::Avx2 })
+            {
+                if (!isLifeKernelSupported(kernel))
+                {
+                    continue;
+                }
+
+                for (auto notation : { "B3/S23", "B36/S23" })
+                {
+                    LifeRule rule(notation);
+                    State state = randomState(sizeX, sizeY, 17);
+                    LifeSimulator simulation = LifeSimulator(sizeX, sizeY, rule);
+                    simulation.setKernel(kernel);
+                    simulation.setBoundary(boundary);
+                    simulation.setThreadCount(kernel == LifeKernelType::Scalar ? 3 : 1);
+                    simulation.insertPattern(PatternState(state), 0, 0);
+
+                    for (int update = 1; update <= 12; update++)
+                    {
+                        simulation.update();
+                        state = referenceUpdate(state, rule, boundary);
+                    }
+                    compareStates(simulation, state, 12);
+
+                    // The wrapped cells put past the right edge while stepping are gone again
+                    std::uint64_t pastEdge = (sizeX % 64 == 0) ? 0 : ~((std::uint64_t{ 1 } << (sizeX % 64)) - 1);
+                    for (std::uint32_t y = 0; y < sizeY; y++)
+                    {
+                        EXPECT_EQ(0u, simulation.getRow(y)[simulation.getWordsPerRow() - 1] & pastEdge);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(LifeSimulator_Boundary, GliderCrossesTheTorus)
+{
+    LifeSimulator simulation = LifeSimulator(100, 20);
+    simulation.setBoundary(LifeBoundary::Torus);
+    EXPECT_EQ(LifeBoundary::Torus, simulation.getBoundary());
+    simulation.insertPattern(PatternGlider(), 90, 10);
+    LifeSimulator start = LifeSimulator(100, 20);
+    start.insertPattern(PatternGlider(), 90, 10);
+
+    // A glider moves one cell diagonally every four generations, so after 4 * lcm(100, 20)
+    // generations it is back where it started
+    simulation.step(400);
+    for (std::uint32_t y = 0; y < 20; y++)
+    {
+        for (std::uint32_t x = 0; x < 100; x++)
+        {
+            ASSERT_EQ(start.getCell(x, y), simulation.getCell(x, y)) << "Wrong cell state at (" << x << ", " << y << ")";
+        }
+    }
+
+    // Switching back to dead edges keeps the cells and stops the wrapping
+    simulation.setBoundary(LifeBoundary::Dead);
+    simulation.step(60);
+    EXPECT_FALSE(simulation.getCell(0, 0));
+}
+
+// Counts and bounds the live cells one at a time
+void expectStatistics(const LifeSimulator& simulation)
+{
+    std::uint64_t population = 0;
+    LifeBoundingBox bounds;
+    for (std::uint32_t y = 0; y < simulation.getSizeY(); y++)
+    {
+        for (std::uint32_t x = 0; x < simulation.getSizeX(); x++)
+        {
+            if (simulation.getCell(x, y))
+            {
+                population++;
+                bounds = bounds.unite({ x, y, 1, 1 });
+            }
+        }
+    }
+    EXPECT_EQ(population, simulation.population());
+    EXPECT_EQ(bounds, simulation.boundingBox());
+}
+
+using StateGrid = std::vector<std::vector<std::uint8_t>>;
+
+StateGrid referenceGenerations(const StateGrid& states, const LifeRule& rule, LifeBoundary boundary)
+{
+    const int sizeY = static_cast<int>(states.size());
+    const int sizeX = static_cast<int>(states[0].size());
+    StateGrid updated = states;
+
+    for (int y = 0; y < sizeY; y++)
+    {
+        for (int x = 0; x < sizeX; x++)
+        {
+            int count = 0;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int nx = boundaryCoordinate(x + dx, sizeX, boundary);
+                    int ny = boundaryCoordinate(y + dy, sizeY, boundary);
+                    if ((dx != 0 || dy != 0) && nx >= 0 && ny >= 0 && states[ny][nx] == 1)
+                    {
+                        count++;
+                    }
+                }
+            }
+
+            std::uint8_t state = states[y][x];
+            if (state == 0)
+            {
+                updated[y][x] = rule.isBorn(count) ? 1 : 0;
+            }
+            else if (state == 1 && rule.survives(count))
+            {
+                updated[y][x] = 1;
+            }
+            else
+            {
+                updated[y][x] = (state + 1u == rule.getStates()) ? 0 : state + 1;
+            }
+        }
+    }
+    return updated;
+}
+
+TEST(LifeSimulator_Generations, EveryKernelMatchesReference)
+{
+    // Brian's Brain, Star Wars and a long decay under Conway's births and survivals
+    for (auto notation : { "B2/S/C3", "B2/S345/C4", "B3/S23/C8" })
+    {
+        for (auto boundary : { LifeBoundary::Dead, LifeBoundary::Torus })
+        {
+            for (auto kernel : { LifeKernelType::Scalar, LifeKernelType::Sse2, LifeKernelType::Avx2 })
+            {
+                if (!isLifeKernelSupported(kernel))
+                {
+                    continue;
+                }
+
+                LifeRule rule(notation);
+                State alive = randomState(300, 70, 23);
+                StateGrid states(70, std::vector<std::uint8_t>(300, 0));
+                for (std::size_t y = 0; y < 70; y++)
+                {
+                    for (std::size_t x = 0; x < 300; x++)
+                    {
+                        states[y][x] = alive[y][x] ? 1 : 0;
+                    }
+                }
+
+                LifeSimulator simulation = LifeSimulator(300, 70, rule);
+                simulation.setKernel(kernel);
+                simulation.setBoundary(boundary);
+                simulation.setThreadCount(kernel == LifeKernelType::Scalar ? 2 : 1);
+                simulation.insertPattern(PatternState(alive), 0, 0);
+
+                for (int update = 1; update <= 15; update++)
+                {
+                    simulation.update();
+                    states = referenceGenerations(states, rule, boundary);
+                }
+                for (std::uint32_t y = 0; y < 70; y++)
+                {
+                    for (std::uint32_t x = 0; x < 300; x++)
+                    {
+                        ASSERT_EQ(states[y][x], simulation.getState(x, y)) << notation << " at (" << x << ", " << y << ")";
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(LifeSimulator_Generations, InsertedCellsReplaceDecayingOnes)
+{
+    LifeSimulator simulation = LifeSimulator(100, 50, LifeRule("B2/S/C3"));
+    EXPECT_EQ(nullptr, LifeSimulator(10, 10).getDecayingRow(0));
+
+    // A lone pair of cells dies straight away and leaves two decaying cells
+    simulation.insertPattern(PatternState(State{ { true, true } }), 40, 20);
+    simulation.update();
+    EXPECT_EQ(2, simulation.getState(40, 20));
+    EXPECT_EQ(2, simulation.getState(41, 20));
+    EXPECT_NE(0u, simulation.getDecayingRow(20)[0]);
+
+    simulation.insertPattern(PatternState(State{ { false } }), 40, 20);
+    EXPECT_EQ(0, simulation.getState(40, 20));
+    EXPECT_EQ(2, simulation.getState(41, 20));
+
+    LifeFrame frame;
+    frame.capture(simulation);
+    EXPECT_EQ(0, frame.getState(40, 20));
+    EXPECT_EQ(2, frame.getState(41, 20));
+    EXPECT_EQ(1, frame.getState(40, 19));
+
+    simulation.clear();
+    EXPECT_EQ(0, simulation.getState(41, 20));
+    EXPECT_THROW(HashLife universe(LifeRule("B2/S/C3")), std::invalid_argument);
+}
+
+TEST(LifeSimulator_Statistics, MatchCellByCellCount)
+{
+    for (std::size_t threads : { 1, 3 })
+    {
+        for (auto boundary : { LifeBoundary::Dead, LifeBoundary::Torus })
+        {
+            LifeSimulator simulation = LifeSimulator(330, 100);
+            simulation.setThreadCount(threads);
+            simulation.setBoundary(boundary);
+            expectStatistics(simulation);
+            EXPECT_TRUE(simulation.boundingBox().isEmpty());
+
+            simulation.insertPattern(PatternState(randomState(150, 60, 5)), 170, 30);
+            expectStatistics(simulation);
+            for (int update = 0; update < 20; update++)
+            {
+                simulation.update();
+                expectStatistics(simulation);
+            }
+
+            simulation.clear();
+            EXPECT_EQ(0u, simulation.population());
+            EXPECT_TRUE(simulation.boundingBox().isEmpty());
+        }
+    }
+}
+
+TEST(LifeSimulator_Statistics, BoundingBoxFollowsGlider)
+{
+    LifeSimulator simulation = LifeSimulator(400, 200);
+    simulation.insertPattern(PatternGlider(), 200, 30);
+    EXPECT_EQ(5u, simulation.population());
+    EXPECT_EQ((LifeBoundingBox{ 200, 30, 3, 3 }), simulation.boundingBox());
+
+    // Across tile borders in both directions
+    simulation.step(400);
+    EXPECT_EQ(5u, simulation.population());
+    EXPECT_EQ((LifeBoundingBox{ 300, 130, 3, 3 }), simulation.boundingBox());
+}
+
+TEST(LifeSimulator_Rule, EmptyBoardComesAliveWithB0)
+{
+    LifeSimulator simulation = LifeSimulator(300, 40, LifeRule("B0/S"));
+
+    simulation.update();
+    EXPECT_TRUE(simulation.getCell(0, 0));
+    EXPECT_TRUE(simulation.getCell(299, 39));
+
+    simulation.update();
+    EXPECT_FALSE(simulation.getCell(150, 20));
+    EXPECT_FALSE(simulation.getCell(0, 0));
+}
+
+TEST(LifeSimulator_Step, SkipsInactiveTiles)
+{
+    LifeSimulator simulation = LifeSimulator(2000, 2000);
+
+    simulation.step(1);
+    EXPECT_EQ(0, simulation.getActiveTileCount());
+
+    // A still life only needs its own tile recomputed once to be known as settled
+    simulation.insertPattern(PatternBlock(), 1000, 1000);
+    simulation.step(1);
+    EXPECT_EQ(9, simulation.getActiveTileCount());
+    EXPECT_EQ(9 * 256 * 32, simulation.getActiveCellCount());
+    simulation.step(1);
+    EXPECT_EQ(0, simulation.getActiveTileCount());
+    EXPECT_EQ(0, simulation.getActiveCellCount());
+    EXPECT_TRUE(simulation.getCell(1000, 1000));
+    EXPECT_TRUE(simulation.getCell(1001, 1001));
+
+    // The corner tiles hang over the board's 2000 cells, so only 208 columns and 16 rows count
+    simulation.insertPattern(PatternBlock(), 1998, 1998);
+    simulation.step(1);
+    EXPECT_EQ(4, simulation.getActiveTileCount());
+    EXPECT_EQ((256 + 208) * (32 + 16), simulation.getActiveCellCount());
+    simulation.step(1);
+
+    // A blinker keeps its neighbourhood active but the rest of the board is never visited
+    simulation.insertPattern(PatternBlinker(), 600, 100);
+    simulation.step(10);
+    EXPECT_EQ(9, simulation.getActiveTileCount());
+}
+
+TEST(LifeSimulator_Step, SparsePatternsCrossingTilesMatchReference)
+{
+    State state(200, std::vector<bool>(600, false));
+    LifeSimulator simulation = LifeSimulator(600, 200);
+
+    simulation.insertPattern(PatternState(state), 0, 0);
+    simulation.insertPattern(PatternGlider(), 250, 28);
+    simulation.insertPattern(PatternAcorn(), 500, 60);
+    simulation.insertPattern(PatternBlinker(), 255, 120);
+
+    for (std::uint32_t y = 0; y < 200; y++)
+    {
+        for (std::uint32_t x = 0; x < 600; x++)
+        {
+            state[y][x] = simulation.getCell(x, y);
+        }
+    }
+
+    for (int update = 1; update <= 120; update++)
+    {
+        simulation.update();
+        state = referenceUpdate(state);
+    }
+    compareStates(simulation, state, 120);
+}
+
+TEST(LifeSimulator_History, DetectsStillLifesAndOscillators)
+{
+    LifeSimulator block = LifeSimulator(20, 20);
+    LifeSimulator blinker = LifeSimulator(20, 20);
+    LifeSimulator pulsar = LifeSimulator(40, 40);
+    block.setPeriodDetection(true);
+    blinker.setPeriodDetection(true);
+    block.insertPattern(PatternBlock(), 5, 5);
+    blinker.insertPattern(PatternBlinker(), 5, 5);
+    pulsar.insertPattern(PatternPulsar(), 10, 10);
+    pulsar.update();
+    pulsar.setPeriodDetection(true);
+
+    EXPECT_FALSE(block.isStable());
+    block.update();
+    EXPECT_TRUE(block.isStable());
+    EXPECT_EQ(1, block.detectedPeriod());
+
+    blinker.update();
+    EXPECT_FALSE(blinker.isStable());
+    blinker.update();
+    EXPECT_EQ(2, blinker.detectedPeriod());
+
+    pulsar.step(2);
+    EXPECT_FALSE(pulsar.isStable());
+    pulsar.update();
+    EXPECT_EQ(3, pulsar.detectedPeriod());
+
+    // Editing the board forgets what came before
+    pulsar.insertPattern(PatternGlider(), 0, 0);
+    EXPECT_FALSE(pulsar.isStable());
+
+    // Even when detection has been turned off since
+    blinker.setPeriodDetection(false);
+    blinker.clear();
+    EXPECT_EQ(0, blinker.detectedPeriod());
+    EXPECT_FALSE(blinker.isStable());
+    block.setPeriodDetection(false);
+    block.insertPattern(PatternGlider(), 10, 10);
+    EXPECT_FALSE(block.isStable());
+}
+
+TEST(LifeSimulator_History, MovingGliderIsNotStable)
+{
+    LifeSimulator simulation = LifeSimulator(300, 300);
+    simulation.setPeriodDetection(true);
+    simulation.insertPattern(PatternGlider(), 0, 0);
+
+    for (int update = 0; update < 200; update++)
+    {
+        simulation.update();
+        ASSERT_FALSE(simulation.isStable()) << update;
+    }
+}
+
+TEST(LifeSimulator_History, IncrementalHashMatchesFreshBoard)
+{
+    State state = randomState(700, 100, 9);
+    LifeSimulator simulation = LifeSimulator(700, 100);
+    simulation.setThreadCount(3);
+    simulation.setPeriodDetection(true);
+    simulation.insertPattern(PatternState(state), 0, 0);
+    std::uint64_t startHash = simulation.getHash();
+    simulation.step(25);
+    EXPECT_NE(startHash, simulation.getHash());
+
+    State stepped(100, std::vector<bool>(700, false));
+    for (std::uint32_t y = 0; y < 100; y++)
+    {
+        for (std::uint32_t x = 0; x < 700; x++)
+        {
+            stepped[y][x] = simulation.getCell(x, y);
+        }
+    }
+    LifeSimulator fresh = LifeSimulator(700, 100);
+    fresh.insertPattern(PatternState(stepped), 0, 0);
+    fresh.setPeriodDetection(true);
+
+    EXPECT_EQ(simulation.getHash(), fresh.getHash());
+}
+
+TEST(LifeSimulator_History, StepUntilStableStopsEarly)
+{
+    State state = randomState(64, 64, 2);
+    LifeSimulator simulation = LifeSimulator(64, 64);
+    simulation.insertPattern(PatternState(state), 0, 0);
+
+    std::size_t generations = simulation.stepUntilStable(5000);
+    EXPECT_LT(generations, 5000);
+    ASSERT_TRUE(simulation.isStable());
+
+    // Stepping on by one period must give back the same board
+    std::size_t period = simulation.detectedPeriod();
+    std::uint64_t hash = simulation.getHash();
+    simulation.step(period);
+    EXPECT_EQ(hash, simulation.getHash());
+    EXPECT_EQ(0, simulation.stepUntilStable(5000));
+}
+
 TEST(LifeSimulator_UpdatePattern, Acorn)
 {
     LifeSimulator simulation = LifeSimulator(10, 6);
@@ -496,4 +1202,860 @@ TEST(LifeSimulator_UpdatePattern, Pulsar)
 
     simulation.update();
     compareStates(simulation, update3, 3);
-}
\ No newline at end of file
+}
+
+void compareUniverses(const LifeSimulator& simulation, const HashLife& universe, const int& updateNum)
+{
+    for (std::uint32_t y = 0; y < simulation.getSizeY(); y++)
+    {
+        for (std::uint32_t x = 0; x < simulation.getSizeX(); x++)
+        {
+            ASSERT_EQ(simulation.getCell(x, y), universe.getCell(x, y))
+                << "Wrong cell state at ("
+                << static_cast<int>(x)
+                << ", "
+                << static_cast<int>(y)
+                << ") at update "
+                << updateNum;
+        }
+    }
+}
+
+TEST(PatternBitmap_Read, RleMatchesEmbeddedPattern)
+{
+    std::istringstream input("#N Gosper glider gun\n"
+                             "#C Comments before the header are skipped\n"
+                             "x = 36, y = 9, rule = B3/S23\n"
+                             "24bo$22bobo$12b2o6b2o12b2o$11bo3bo4b2o12b2o$2o8bo5bo3b2o$2o8bo3bob2o4bobo$\n"
+                             "10bo5bo7bo$11bo3bo$12b2o!\n");
+    PatternBitmap pattern = PatternBitmap::readRle(input);
+    PatternGosperGliderGun gun;
+
+    ASSERT_EQ(gun.getSizeX(), pattern.getSizeX());
+    ASSERT_EQ(gun.getSizeY(), pattern.getSizeY());
+    for (std::uint32_t y = 0; y < gun.getSizeY(); y++)
+    {
+        for (std::uint32_t x = 0; x < gun.getSizeX(); x++)
+        {
+            EXPECT_EQ(gun.getCell(x, y), pattern.getCell(x, y)) << "Wrong cell state at (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(PatternBitmap_Read, RleRunsAcrossWords)
+{
+    std::istringstream input("x = 300, y = 4\n3b290o$$300o$o298bo!");
+    PatternBitmap pattern = PatternBitmap::readRle(input);
+
+    EXPECT_EQ(5, pattern.getWordsPerRow());
+    for (std::uint32_t x = 0; x < 300; x++)
+    {
+        EXPECT_EQ(x >= 3 && x < 293, pattern.getCell(x, 0)) << x;
+        EXPECT_FALSE(pattern.getCell(x, 1)) << x;
+        EXPECT_TRUE(pattern.getCell(x, 2)) << x;
+        EXPECT_EQ(x == 0 || x == 299, pattern.getCell(x, 3)) << x;
+    }
+    // Bits past the right edge stay clear so rows can be copied whole
+    EXPECT_EQ(0, pattern.getRow(2)[4] >> (300 % 64));
+}
+
+TEST(PatternBitmap_Read, PlaintextWithRaggedRows)
+{
+    std::istringstream input("!Name: Glider\r\n!\r\n.O\r\n..O\r\nOOO\r\n");
+    PatternBitmap pattern = PatternBitmap::readPlaintext(input);
+
+    State glider = {
+        { false, true, false },
+        { false, false, true },
+        { true, true, true }
+    };
+    ASSERT_EQ(3, pattern.getSizeX());
+    ASSERT_EQ(3, pattern.getSizeY());
+    for (std::uint32_t y = 0; y < 3; y++)
+    {
+        for (std::uint32_t x = 0; x < 3; x++)
+        {
+            EXPECT_EQ(glider[y][x], pattern.getCell(x, y));
+        }
+    }
+}
+
+TEST(PatternBitmap_Read, RejectsBadInput)
+{
+    for (auto text : { "", "y = 3\no!", "x = 3, y = 3\n4o!", "x = 3, y = 1\no$o!", "x = 3, y = 3\n3o", "x = 3, y = 3\no?o!", "x = 4000000000, y = 4000000000\no!", "x = 65536, y = 65536\no!" })
+    {
+        std::istringstream input(text);
+        EXPECT_THROW(PatternBitmap::readRle(input), std::runtime_error) << text;
+    }
+
+    std::istringstream plaintext(".O.\nO#O\n");
+    EXPECT_THROW(PatternBitmap::readPlaintext(plaintext), std::runtime_error);
+    EXPECT_THROW(PatternBitmap::load("no such pattern.rle"), std::runtime_error);
+}
+
+TEST(LifeRule_Parse, ReadsBirthAndSurvivalCounts)
+{
+    LifeRule highLife("B36/S23");
+    EXPECT_EQ((1 << 3) | (1 << 6), highLife.getBirthCounts());
+    EXPECT_EQ((1 << 2) | (1 << 3), highLife.getSurvivalCounts());
+    EXPECT_TRUE(highLife.isBorn(6));
+    EXPECT_FALSE(highLife.survives(6));
+    EXPECT_EQ("B36/S23", highLife.toString());
+
+    EXPECT_EQ(LifeRule(), LifeRule("B3/S23"));
+    EXPECT_EQ(LifeRule(), LifeRule("s32/b3"));
+    EXPECT_EQ(LifeRule(), LifeRule("23/3"));
+    EXPECT_EQ("B2/S", LifeRule("B2/S").toString());
+}
+
+TEST(LifeRule_Parse, ReadsGenerationsRules)
+{
+    LifeRule briansBrain("B2/S/C3");
+    EXPECT_EQ(3u, briansBrain.getStates());
+    EXPECT_EQ(LifeRule(1 << 2, 0, 3), briansBrain);
+    EXPECT_EQ(briansBrain, LifeRule("/2/3"));
+    EXPECT_EQ(briansBrain, LifeRule("b2/s/3"));
+    EXPECT_EQ("B2/S/C3", briansBrain.toString());
+    EXPECT_EQ("B2/S345/C4", LifeRule("345/2/4").toString());
+    EXPECT_FALSE(LifeRule("B3/S23/C2") == LifeRule("B3/S23/C3"));
+    EXPECT_EQ(LifeRule(), LifeRule("B3/S23/C2"));
+    EXPECT_THROW(LifeRule(1 << 3, 0, 1), std::invalid_argument);
+}
+
+TEST(LifeRule_Parse, RejectsBadNotation)
+{
+    for (auto notation : { "", "B3S23", "B39/S23", "B3/S2/3/4", "B3/B23", "X3/S23", "B3/S 23", "B2/S/C", "B2/S/C1", "B2/S/C256" })
+    {
+        EXPECT_THROW(LifeRule rule(notation), std::invalid_argument) << notation;
+    }
+}
+
+TEST(HashLife_InsertPattern, CanInsertAnywhere)
+{
+    HashLife universe;
+
+    universe.insertPattern(PatternTestToad(), 1, 1);
+    universe.insertPattern(PatternOneByOne(), -1000000, 5000000);
+
+    EXPECT_EQ(7, universe.getPopulation());
+    EXPECT_TRUE(universe.getCell(2, 1));
+    EXPECT_TRUE(universe.getCell(1, 2));
+    EXPECT_FALSE(universe.getCell(1, 1));
+    EXPECT_TRUE(universe.getCell(-1000000, 5000000));
+    EXPECT_FALSE(universe.getCell(-1000001, 5000000));
+}
+
+TEST(HashLife_Advance, MatchesLifeSimulator)
+{
+    LifeSimulator simulation = LifeSimulator(400, 300);
+    HashLife universe;
+
+    simulation.insertPattern(PatternGosperGliderGun(), 20, 20);
+    simulation.insertPattern(PatternAcorn(), 250, 150);
+    universe.insertPattern(PatternGosperGliderGun(), 20, 20);
+    universe.insertPattern(PatternAcorn(), 250, 150);
+
+    // Mix single generations with larger jumps so several step sizes are exercised
+    int generation = 0;
+    for (std::uint64_t generations : { 1, 1, 2, 5, 16, 31, 64, 80 })
+    {
+        simulation.step(generations);
+        universe.advance(generations);
+        generation += static_cast<int>(generations);
+
+        EXPECT_EQ(static_cast<std::uint64_t>(generation), universe.getGeneration());
+        compareUniverses(simulation, universe, generation);
+    }
+}
+
+TEST(HashLife_Advance, MatchesLifeSimulatorForHighLife)
+{
+    LifeRule rule("B36/S23");
+    LifeSimulator simulation = LifeSimulator(400, 300, rule);
+    HashLife universe(rule);
+
+    // 60 generations cannot carry anything from the soup to the edge of the board
+    State soup = randomState(40, 40, 5);
+    simulation.insertPattern(PatternState(soup), 180, 130);
+    universe.insertPattern(PatternState(soup), 180, 130);
+
+    simulation.step(60);
+    universe.advance(60);
+    compareUniverses(simulation, universe, 60);
+}
+
+TEST(HashLife_Advance, GliderGunMillionGenerations)
+{
+    HashLife universe;
+
+    universe.insertPattern(PatternGosperGliderGun(), 0, 0);
+    universe.setNodeLimit(1 << 16);
+    universe.advance(1000000);
+
+    // Once running, the gun adds one five-cell glider every 30 generations
+    std::uint64_t population = universe.getPopulation();
+    universe.advance(30);
+
+    EXPECT_EQ(1000030, universe.getGeneration());
+    EXPECT_EQ(population + 5, universe.getPopulation());
+
+    universe.collectGarbage();
+    EXPECT_EQ(population + 5, universe.getPopulation());
+    universe.advance(30);
+    EXPECT_EQ(population + 10, universe.getPopulation());
+}
+
+TEST(HashLife_Advance, MixedStepSizesMatchAcrossGarbageCollection)
+{
+    HashLife mixed;
+    HashLife steady;
+
+    // 37 generations take steps of 1, 4 and 32; 1024 a single large step that reuses their subtrees
+    mixed.insertPattern(PatternGosperGliderGun(), 0, 0);
+    mixed.setNodeLimit(1 << 12);
+    steady.insertPattern(PatternGosperGliderGun(), 0, 0);
+    for (int round = 0; round < 4; round++)
+    {
+        mixed.advance(37);
+        mixed.advance(1024);
+        steady.advance(1061);
+    }
+    mixed.collectGarbage();
+    mixed.advance(37);
+    steady.advance(37);
+
+    ASSERT_EQ(steady.getGeneration(), mixed.getGeneration());
+    ASSERT_EQ(steady.getPopulation(), mixed.getPopulation());
+    for (std::int64_t y = -20; y < 1200; y++)
+    {
+        for (std::int64_t x = -20; x < 1200; x++)
+        {
+            ASSERT_EQ(steady.getCell(x, y), mixed.getCell(x, y)) << "x = " << x << ", y = " << y;
+        }
+    }
+}
+
+TEST(SparseLifeSimulator_Update, GliderTravelsWithoutEdges)
+{
+    SparseLifeSimulator universe;
+
+    universe.insertPattern(PatternGlider(), -2, -2);
+    EXPECT_EQ(5, universe.getPopulation());
+
+    // 4000 generations move the glider 1000 cells across several chunks
+    universe.step(4000);
+
+    EXPECT_EQ(5, universe.getPopulation());
+    EXPECT_LE(universe.getChunkCount(), 4);
+    EXPECT_TRUE(universe.getCell(1000, 998));
+    EXPECT_TRUE(universe.getCell(998, 999));
+    EXPECT_TRUE(universe.getCell(1000, 999));
+    EXPECT_TRUE(universe.getCell(999, 1000));
+    EXPECT_TRUE(universe.getCell(1000, 1000));
+}
+
+TEST(SparseLifeSimulator_Update, DistantChunksStaySeparate)
+{
+    SparseLifeSimulator universe;
+
+    // 2^40 cells is 2^32 chunks across, which a key cut to 32 bits per axis would fold onto chunk 0
+    std::int64_t far = std::int64_t{ 1 } << 40;
+    universe.insertPattern(PatternBlock(), 10, 10);
+    universe.insertPattern(PatternBlinker(), far + 20, 10);
+    EXPECT_EQ(2, universe.getChunkCount());
+    EXPECT_EQ(7, universe.getPopulation());
+
+    universe.step(3);
+    EXPECT_EQ(7, universe.getPopulation());
+    EXPECT_TRUE(universe.getCell(10, 10));
+    EXPECT_FALSE(universe.getCell(far + 10, 10));
+    // The blinker at x = far + 20 is horizontal after an odd number of generations
+    EXPECT_TRUE(universe.getCell(far + 21, 11));
+    EXPECT_FALSE(universe.getCell(far + 20, 10));
+    EXPECT_FALSE(universe.getCell(21, 11));
+}
+
+TEST(SparseLifeSimulator_Constructor, RejectsB0Rules)
+{
+    EXPECT_THROW(SparseLifeSimulator universe(LifeRule("B0/S8")), std::invalid_argument);
+    EXPECT_THROW(HashLife universe(LifeRule("B03/S23")), std::invalid_argument);
+}
+
+TEST(SparseLifeSimulator_Update, MatchesHashLife)
+{
+    SparseLifeSimulator sparse;
+    HashLife universe;
+
+    sparse.insertPattern(PatternGosperGliderGun(), -300, -40);
+    sparse.insertPattern(PatternAcorn(), 20, 10);
+    universe.insertPattern(PatternGosperGliderGun(), -300, -40);
+    universe.insertPattern(PatternAcorn(), 20, 10);
+
+    sparse.step(300);
+    universe.advance(300);
+
+    EXPECT_EQ(universe.getPopulation(), sparse.getPopulation());
+    for (std::int64_t y = -200; y < 200; y++)
+    {
+        for (std::int64_t x = -400; x < 200; x++)
+        {
+            ASSERT_EQ(universe.getCell(x, y), sparse.getCell(x, y)) << "Wrong cell state at (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(SparseLifeSimulator_Viewport, CopiesWindowIntoSimulator)
+{
+    SparseLifeSimulator universe;
+    LifeSimulator viewport = LifeSimulator(6, 4);
+
+    universe.insertPattern(PatternTestToad(), -1000, 700);
+    viewport.insertPattern(PatternOneByOne(), 0, 0);
+    universe.copyViewport(viewport, -1001, 699);
+
+    State window = {
+        { false, false, false, false, false, false },
+        { false, false, true, true, true, false },
+        { false, true, true, true, false, false },
+        { false, false, false, false, false, false }
+    };
+
+    compareStates(viewport, window, 0);
+}
+
+std::string snapshotPath(const std::string& name)
+{
+    return (std::filesystem::temp_directory_path() / ("TestGameOfLife_" + name)).string();
+}
+
+void compareSimulations(const LifeSimulator& expected, const LifeSimulator& actual)
+{
+    ASSERT_EQ(expected.getSizeX(), actual.getSizeX());
+    ASSERT_EQ(expected.getSizeY(), actual.getSizeY());
+    EXPECT_EQ(expected.getGeneration(), actual.getGeneration());
+    for (std::uint32_t y = 0; y < expected.getSizeY(); y++)
+    {
+        for (std::uint32_t x = 0; x < expected.getSizeX(); x++)
+        {
+            ASSERT_EQ(expected.getState(x, y), actual.getState(x, y)) << "Wrong cell state at (" << x << ", " << y << ")";
+        }
+    }
+}
+
+TEST(SnapshotFile_Restore, MappedSnapshotResumesRun)
+{
+    std::string path = snapshotPath("mapped.snapshot");
+    LifeSimulator simulation = LifeSimulator(333, 70, LifeRule("B36/S23"));
+    simulation.insertPattern(PatternState(randomState(333, 70, 21)), 0, 0);
+    simulation.step(7);
+
+    SnapshotFile::write(path, simulation, false);
+    {
+        SnapshotFile snapshot(path);
+        EXPECT_TRUE(snapshot.isMapped());
+        EXPECT_EQ(7, snapshot.getGeneration());
+        EXPECT_EQ(LifeRule("B36/S23"), snapshot.getRule());
+        EXPECT_EQ(sizeof(SnapshotHeader) + 6 * 70 * sizeof(std::uint64_t), std::filesystem::file_size(path));
+    }
+
+    LifeSimulator restored = SnapshotFile::restore(path);
+    EXPECT_EQ(simulation.getRule(), restored.getRule());
+    compareSimulations(simulation, restored);
+
+    simulation.step(10);
+    restored.step(10);
+    compareSimulations(simulation, restored);
+    std::filesystem::remove(path);
+}
+
+TEST(SnapshotFile_Restore, CompressedSnapshotIsSmaller)
+{
+    std::string path = snapshotPath("compressed.snapshot");
+    LifeSimulator simulation = LifeSimulator(2000, 1000);
+    simulation.insertPattern(PatternGosperGliderGun(), 10, 10);
+    simulation.insertPattern(PatternAcorn(), 1500, 900);
+    simulation.insertPattern(PatternState(randomState(130, 3, 8)), 1000, 500);
+    simulation.step(100);
+
+    SnapshotFile::write(path, simulation, true);
+    EXPECT_LT(std::filesystem::file_size(path), 4000);
+
+    SnapshotFile snapshot(path);
+    EXPECT_FALSE(snapshot.isMapped());
+    LifeSimulator restored = SnapshotFile::restore(path);
+    compareSimulations(simulation, restored);
+    std::filesystem::remove(path);
+}
+
+TEST(SnapshotFile_Restore, RestoredBoundaryMatchesUninterruptedRun)
+{
+    for (LifeBoundary boundary : { LifeBoundary::Torus, LifeBoundary::Mirror })
+    {
+        std::string path = snapshotPath("boundary.snapshot");
+        LifeSimulator checkpointed = LifeSimulator(70, 45);
+        LifeSimulator uninterrupted = LifeSimulator(70, 45);
+        for (LifeSimulator* simulation : { &checkpointed, &uninterrupted })
+        {
+            simulation->setBoundary(boundary);
+            simulation->insertPattern(PatternState(randomState(70, 45, 31)), 0, 0);
+            simulation->step(20);
+        }
+
+        // Cells keep crossing the edges after the restore, so a Dead boundary would soon differ
+        SnapshotFile::write(path, checkpointed, true);
+        EXPECT_EQ(boundary, SnapshotFile(path).getBoundary());
+        LifeSimulator restored = SnapshotFile::restore(path);
+        EXPECT_EQ(boundary, restored.getBoundary());
+
+        restored.step(60);
+        uninterrupted.step(60);
+        compareSimulations(uninterrupted, restored);
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(SnapshotFile_Restore, RestoredDecayMatchesUninterruptedRun)
+{
+    for (bool compress : { false, true })
+    {
+        std::string path = snapshotPath("decay.snapshot");
+        LifeSimulator checkpointed = LifeSimulator(150, 80, LifeRule("B2/S/C3"));
+        LifeSimulator uninterrupted = LifeSimulator(150, 80, LifeRule("B2/S/C3"));
+        for (LifeSimulator* simulation : { &checkpointed, &uninterrupted })
+        {
+            simulation->insertPattern(PatternState(randomState(150, 80, 41)), 0, 0);
+            simulation->step(15);
+        }
+
+        // Decaying cells block births, so losing them would change the very next generation
+        SnapshotFile::write(path, checkpointed, compress);
+        LifeSimulator restored = SnapshotFile::restore(path);
+        compareSimulations(checkpointed, restored);
+
+        restored.step(40);
+        uninterrupted.step(40);
+        compareSimulations(uninterrupted, restored);
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(SnapshotFile_Restore, RejectsDamagedFiles)
+{
+    std::string path = snapshotPath("damaged.snapshot");
+    LifeSimulator simulation = LifeSimulator(100, 100);
+    simulation.insertPattern(PatternGlider(), 50, 50);
+    SnapshotFile::write(path, simulation, false);
+
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_THROW(SnapshotFile snapshot(path), std::runtime_error);
+
+    // A decaying state past the rule's last one
+    LifeSimulator decaying = LifeSimulator(100, 100, LifeRule("B2/S/C3"));
+    SnapshotFile::write(path, decaying, false);
+    {
+        std::fstream output(path, std::ios::binary | std::ios::in | std::ios::out);
+        output.seekp(static_cast<std::streamoff>(sizeof(SnapshotHeader) + 2 * 100 * sizeof(std::uint64_t) + 5));
+        output.put(3);
+    }
+    EXPECT_THROW(SnapshotFile snapshot(path), std::runtime_error);
+
+    // A compressed board whose size was damaged must be rejected before it is allocated
+    SnapshotFile::write(path, simulation, true);
+    {
+        std::fstream output(path, std::ios::binary | std::ios::in | std::ios::out);
+        std::uint32_t size = 0xffffffff;
+        output.seekp(static_cast<std::streamoff>(offsetof(SnapshotHeader, sizeX)));
+        output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        output.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    }
+    EXPECT_THROW(SnapshotFile snapshot(path), std::runtime_error);
+
+    {
+        std::ofstream output(path, std::ios::binary | std::ios::trunc);
+        output << "x = 3, y = 3\n2bo$obo$b2o!";
+    }
+    EXPECT_THROW(SnapshotFile snapshot(path), std::runtime_error);
+    std::filesystem::remove(path);
+    EXPECT_THROW(SnapshotFile snapshot(path), std::runtime_error);
+}
+
+TEST(SnapshotWriter_Save, WritesBoardAsItWasWhenSaved)
+{
+    std::string first = snapshotPath("writer1.snapshot");
+    std::string second = snapshotPath("writer2.snapshot");
+    LifeSimulator simulation = LifeSimulator(500, 200);
+    simulation.insertPattern(PatternState(randomState(500, 200, 13)), 0, 0);
+    simulation.step(3);
+
+    LifeSimulator expected = LifeSimulator(500, 200);
+    expected.insertPattern(PatternState(randomState(500, 200, 13)), 0, 0);
+    expected.step(3);
+
+    SnapshotWriter writer;
+    writer.save(simulation, first);
+    // Keep stepping while the snapshot is written
+    simulation.step(5);
+    writer.save(simulation, second, true);
+    simulation.step(5);
+    writer.wait();
+
+    compareSimulations(expected, SnapshotFile::restore(first));
+    expected.step(5);
+    compareSimulations(expected, SnapshotFile::restore(second));
+
+    writer.save(simulation, snapshotPath("missing directory/writer.snapshot"));
+    EXPECT_THROW(writer.wait(), std::runtime_error);
+
+    std::filesystem::remove(first);
+    std::filesystem::remove(second);
+}
+
+TEST(SnapshotWriter_Save, QueueStaysWithinItsLength)
+{
+    LifeSimulator simulation = LifeSimulator(2000, 2000);
+    simulation.insertPattern(PatternState(randomState(2000, 2000, 17)), 0, 0);
+
+    // Every save goes to a new path, so none can replace another and only blocking bounds the queue
+    SnapshotWriter writer(2);
+    std::vector<std::string> paths;
+    for (int save = 0; save < 12; save++)
+    {
+        paths.push_back(snapshotPath("queue" + std::to_string(save) + ".snapshot"));
+        writer.save(simulation, paths.back());
+        EXPECT_LE(writer.getQueuedCount(), 2);
+    }
+    writer.wait();
+    EXPECT_EQ(0, writer.getQueuedCount());
+
+    for (const auto& path : paths)
+    {
+        compareSimulations(simulation, SnapshotFile::restore(path));
+        std::filesystem::remove(path);
+    }
+    EXPECT_THROW(SnapshotWriter(0), std::invalid_argument);
+}
+
+TEST(ThreadPool_ParallelForEach, RunsEveryIndexOnce)
+{
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> runs(1000);
+    std::vector<std::atomic<int>> threads(pool.getThreadCount());
+
+    // The first indices are slow, so the threads holding them have work stolen
+    pool.parallelForEach(runs.size(), [&](std::size_t index, std::size_t thread)
+                         {
+                             if (index < 10)
+                             {
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                             }
+                             runs[index]++;
+                             threads[thread]++;
+                         });
+
+    for (auto& count : runs)
+    {
+        EXPECT_EQ(1, count.load());
+    }
+    int total = 0;
+    for (auto& count : threads)
+    {
+        total += count.load();
+    }
+    EXPECT_EQ(1000, total);
+
+    pool.parallelForEach(0, [](std::size_t, std::size_t)
+                         {
+                             FAIL();
+                         });
+}
+
+TEST(LifeSimulator_Clear, ClearedSimulatorMatchesNewOne)
+{
+    LifeSimulator simulation = LifeSimulator(300, 100);
+    simulation.setPeriodDetection(true);
+    simulation.insertPattern(PatternState(randomState(300, 100, 21)), 0, 0);
+    simulation.step(10);
+
+    simulation.clear();
+    EXPECT_EQ(0u, simulation.getGeneration());
+    EXPECT_FALSE(simulation.isStable());
+    simulation.insertPattern(PatternAcorn(), 100, 50);
+    simulation.step(30);
+
+    LifeSimulator expected = LifeSimulator(300, 100);
+    expected.insertPattern(PatternAcorn(), 100, 50);
+    expected.step(30);
+    compareSimulations(expected, simulation);
+}
+
+TEST(SoupSearch_Run, ResultsDoNotDependOnThreads)
+{
+    SoupSearchOptions options;
+    options.soupSize = 12;
+    options.boardSize = 64;
+    options.maxGenerations = 2000;
+    options.seed = 7;
+
+    SoupSearch serial(options);
+    SoupSearchResult expected = serial.run(0, 40);
+    options.threads = 3;
+    SoupSearch parallel(options);
+    SoupSearchResult actual = parallel.run(0, 40);
+
+    EXPECT_EQ(40u, expected.soups);
+    EXPECT_GT(expected.stabilized, 0u);
+    EXPECT_EQ(expected.stabilized, actual.stabilized);
+    EXPECT_EQ(expected.generations, actual.generations);
+    EXPECT_EQ(expected.population, actual.population);
+    EXPECT_EQ(expected.objects, actual.objects);
+    EXPECT_EQ(expected.periods, actual.periods);
+    EXPECT_EQ(expected.objectSizes, actual.objectSizes);
+
+    // Splitting the batch gives the same totals
+    SoupSearchResult split = parallel.run(0, 15);
+    split.merge(parallel.run(15, 25));
+    EXPECT_EQ(expected.generations, split.generations);
+    EXPECT_EQ(expected.population, split.population);
+}
+
+TEST(SoupSearch_CountObjects, CountsConnectedGroups)
+{
+    LifeSimulator simulation = LifeSimulator(100, 40);
+    simulation.insertPattern(PatternBlock(), 0, 0);
+    simulation.insertPattern(PatternBlinker(), 62, 10);
+    simulation.insertPattern(PatternGlider(), 95, 35);
+    // Two blocks touching at a corner are one group
+    simulation.insertPattern(PatternBlock(), 20, 20);
+    simulation.insertPattern(PatternBlock(), 22, 22);
+
+    std::vector<std::uint64_t> sizes(10, 0);
+    EXPECT_EQ(4u, SoupSearch::countObjects(simulation, sizes));
+    EXPECT_EQ(1u, sizes[3]);
+    EXPECT_EQ(1u, sizes[4]);
+    EXPECT_EQ(1u, sizes[5]);
+    EXPECT_EQ(1u, sizes[8]);
+}
+
+TEST(LifeFrame_Capture, CopiesBoardAndGeneration)
+{
+    LifeSimulator simulation = LifeSimulator(130, 20);
+    simulation.insertPattern(PatternState(randomState(130, 20, 4)), 0, 0);
+    simulation.step(3);
+
+    LifeFrame frame;
+    frame.capture(simulation);
+    simulation.step(1);
+
+    LifeSimulator expected = LifeSimulator(130, 20);
+    expected.insertPattern(PatternState(randomState(130, 20, 4)), 0, 0);
+    expected.step(3);
+    EXPECT_EQ(3u, frame.getGeneration());
+    ASSERT_EQ(130u, frame.getSizeX());
+    ASSERT_EQ(20u, frame.getSizeY());
+    for (std::uint32_t y = 0; y < 20; y++)
+    {
+        for (std::uint32_t x = 0; x < 130; x++)
+        {
+            ASSERT_EQ(expected.getCell(x, y), frame.getCell(x, y));
+        }
+    }
+}
+
+TEST(LifeFrameSlot_Take, OnlyLatestFrameIsTaken)
+{
+    LifeFrameSlot slot;
+    LifeSimulator simulation = LifeSimulator(10, 10);
+    EXPECT_FALSE(slot.takeLatest());
+
+    // Frames 0 and 1 are dropped because the consumer never asked for them
+    for (int generation = 0; generation < 3; generation++)
+    {
+        slot.getWriteFrame().capture(simulation);
+        slot.publish();
+        simulation.update();
+    }
+    EXPECT_TRUE(slot.takeLatest());
+    EXPECT_EQ(2u, slot.getReadFrame().getGeneration());
+    EXPECT_FALSE(slot.takeLatest());
+    EXPECT_EQ(2u, slot.getReadFrame().getGeneration());
+
+    slot.getWriteFrame().capture(simulation);
+    slot.publish();
+    EXPECT_TRUE(slot.takeLatest());
+    EXPECT_EQ(3u, slot.getReadFrame().getGeneration());
+}
+
+TEST(LifeFrameSlot_Take, WantsFrameOnlyOnceTheLastIsTaken)
+{
+    LifeFrameSlot slot;
+    LifeSimulator simulation = LifeSimulator(10, 10);
+    EXPECT_TRUE(slot.wantsFrame());
+
+    slot.getWriteFrame().capture(simulation);
+    slot.publish();
+    EXPECT_FALSE(slot.wantsFrame());
+
+    // Taking empties the slot, and a second take finds nothing and changes nothing
+    EXPECT_TRUE(slot.takeLatest());
+    EXPECT_TRUE(slot.wantsFrame());
+    EXPECT_FALSE(slot.takeLatest());
+    EXPECT_TRUE(slot.wantsFrame());
+
+    simulation.update();
+    slot.getWriteFrame().capture(simulation);
+    slot.publish();
+    EXPECT_FALSE(slot.wantsFrame());
+    EXPECT_TRUE(slot.takeLatest());
+    EXPECT_EQ(1u, slot.getReadFrame().getGeneration());
+}
+
+TEST(LifeFrameSlot_Take, ConsumerSeesWholeFramesInOrder)
+{
+    LifeFrameSlot slot;
+    std::atomic<bool> done = false;
+
+    // Every cell of a frame is alive on odd generations and dead on even ones, so a frame the
+    // producer was still writing would show up as a mix
+    std::thread producer([&]()
+                         {
+                             LifeSimulator simulation = LifeSimulator(256, 64, LifeRule("B012345678/S"));
+                             for (int generation = 0; generation < 5000; generation++)
+                             {
+                                 simulation.update();
+                                 slot.getWriteFrame().capture(simulation);
+                                 slot.publish();
+                             }
+                             done = true;
+                         });
+
+    std::uint64_t lastGeneration = 0;
+    std::size_t taken = 0;
+    while (true)
+    {
+        // Read before taking, so the last frame is still checked once the producer is done
+        bool finished = done;
+        if (!slot.takeLatest())
+        {
+            if (finished)
+            {
+                break;
+            }
+            continue;
+        }
+        const LifeFrame& frame = slot.getReadFrame();
+        ASSERT_GT(frame.getGeneration(), lastGeneration);
+        lastGeneration = frame.getGeneration();
+        taken++;
+
+        std::uint64_t expected = (lastGeneration % 2 == 1) ? ~std::uint64_t{ 0 } : 0;
+        for (std::uint32_t y = 0; y < frame.getSizeY(); y++)
+        {
+            for (std::size_t word = 0; word < frame.getWordsPerRow(); word++)
+            {
+                ASSERT_EQ(expected, frame.getRow(y)[word]);
+            }
+        }
+    }
+    producer.join();
+    EXPECT_GT(taken, 0u);
+}
+
+#if !defined(_WIN32)
+TEST(RendererConsole_Render, OnlyDrawsChangedCells)
+{
+    LifeSimulator simulation = LifeSimulator(6, 6);
+    RendererConsole renderer;
+
+    simulation.insertPattern(PatternBlinker(), 2, 2);
+
+    testing::internal::CaptureStdout();
+    renderer.render(simulation);
+    std::string first = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(3, std::count(first.begin(), first.end(), 'X'));
+
+    // Redrawing an unchanged board writes nothing at all
+    testing::internal::CaptureStdout();
+    renderer.render(simulation);
+    EXPECT_EQ("", testing::internal::GetCapturedStdout());
+
+    // The blinker flips: two cells appear and two are erased, the centre is left alone
+    simulation.update();
+    testing::internal::CaptureStdout();
+    renderer.render(simulation);
+    std::string flipped = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(2, std::count(flipped.begin(), flipped.end(), 'X'));
+    EXPECT_EQ(2, std::count(flipped.begin(), flipped.end(), ' '));
+    EXPECT_EQ(std::string::npos, flipped.find("\033[2J"));
+}
+#endif
+
+std::string readFile(const std::string& path)
+{
+    std::ifstream input(path, std::ios::binary);
+    std::stringstream contents;
+    contents << input.rdbuf();
+    return contents.str();
+}
+
+TEST(RendererImage_Render, ScalesCellsToPixels)
+{
+    std::string path = snapshotPath("image.pgm");
+    LifeSimulator simulation = LifeSimulator(70, 3);
+    simulation.insertPattern(PatternState(randomState(70, 3, 9)), 0, 0);
+
+    RendererImage renderer(path, 2);
+    renderer.render(simulation);
+    renderer.wait();
+
+    std::string header = "P5\n140 6\n255\n";
+    std::string image = readFile(renderer.getFramePath(0));
+    ASSERT_EQ(header.size() + 140 * 6, image.size());
+    EXPECT_EQ(header, image.substr(0, header.size()));
+    for (std::uint32_t y = 0; y < 6; y++)
+    {
+        for (std::uint32_t x = 0; x < 140; x++)
+        {
+            char expected = simulation.getCell(x / 2, y / 2) ? static_cast<char>(255) : 0;
+            ASSERT_EQ(expected, image[header.size() + y * 140 + x]) << "at (" << x << ", " << y << ")";
+        }
+    }
+    std::filesystem::remove(renderer.getFramePath(0));
+}
+
+TEST(RendererImage_Render, AnimationAppendsEveryFrame)
+{
+    std::string path = snapshotPath("animation.ppm");
+    LifeSimulator simulation = LifeSimulator(8, 8, LifeRule("B2/S/C3"));
+    simulation.insertPattern(PatternState(State{ { true, true } }), 3, 3);
+
+    {
+        // A queue of one frame makes every render wait for the previous frame to be written
+        RendererImage renderer(path, 1, true, 1);
+        EXPECT_EQ(snapshotPath("animation-000012.ppm"), renderer.getFramePath(12));
+        for (int frame = 0; frame < 3; frame++)
+        {
+            LifeFrame captured;
+            captured.capture(simulation);
+            renderer.render(captured);
+            simulation.update();
+        }
+    }
+
+    std::string header = "P6\n8 8\n255\n";
+    std::size_t frameSize = header.size() + 8 * 8 * 3;
+    std::string image = readFile(path);
+    ASSERT_EQ(3 * frameSize, image.size());
+    auto pixel = [&](int frame, int x, int y) { return image.substr(frame * frameSize + header.size() + (y * 8 + x) * 3, 3); };
+
+    // The pair is alive, then decaying, then dead
+    EXPECT_EQ(header, image.substr(frameSize, header.size()));
+    EXPECT_EQ("\xff\xff\x55", pixel(0, 3, 3));
+    EXPECT_EQ(std::string(3, '\0'), pixel(0, 2, 3));
+    EXPECT_EQ("\xff\x55\x55", pixel(1, 4, 3));
+    EXPECT_EQ(std::string(3, '\0'), pixel(2, 4, 3));
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(RendererImage(path, 0), std::invalid_argument);
+    EXPECT_THROW(RendererImage(snapshotPath("missing directory/life.pgm")), std::runtime_error);
+    EXPECT_THROW(RendererImage(snapshotPath("missing directory/life.pgm"), 1, true), std::runtime_error);
+}
@@ -0,0 +1,201 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    // The unclaimed indices of one thread, begin in the low half and end in the high half, so
+    // the owner and thieves can both update them with a single compare and swap. Each range sits
+    // on its own cache line.
+    class alignas(64) StealRange
+    {
+      public:
+        std::atomic<std::uint64_t> bounds;
+    };
+
+    std::uint64_t packRange(std::uint64_t begin, std::uint64_t end)
+    {
+        return begin | (end << 32);
+    }
+
+    std::uint64_t getBegin(std::uint64_t bounds)
+    {
+        return bounds & 0xffffffff;
+    }
+
+    std::uint64_t getEnd(std::uint64_t bounds)
+    {
+        return bounds >> 32;
+    }
+
+    bool claimFront(StealRange& range, std::size_t& index)
+    {
+        std::uint64_t bounds = range.bounds.load();
+        while (getBegin(bounds) < getEnd(bounds))
+        {
+            if (range.bounds.compare_exchange_weak(bounds, packRange(getBegin(bounds) + 1, getEnd(bounds))))
+            {
+                index = static_cast<std::size_t>(getBegin(bounds));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Moves the back half of the victim's range, or its last index, into the thief's empty range
+    bool stealBack(StealRange& victim, StealRange& thief)
+    {
+        std::uint64_t bounds = victim.bounds.load();
+        while (getBegin(bounds) < getEnd(bounds))
+        {
+            std::uint64_t middle = getBegin(bounds) + (getEnd(bounds) - getBegin(bounds)) / 2;
+            if (victim.bounds.compare_exchange_weak(bounds, packRange(getBegin(bounds), middle)))
+            {
+                thief.bounds.store(packRange(middle, getEnd(bounds)));
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+ThreadPool::ThreadPool(std::size_t threadCount)
+{
+    // The caller of parallelFor acts as the first thread
+    for (std::size_t i = 1; i < std::max(threadCount, std::size_t{ 1 }); i++)
+    {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_workReady.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+std::size_t ThreadPool::getThreadCount() const
+{
+    return m_workers.size() + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& task)
+{
+    if (m_workers.empty())
+    {
+        task(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_pending = m_workers.size();
+        m_generation++;
+    }
+    m_workReady.notify_all();
+
+    this->runRange(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_workDone.wait(lock, [this]
+                    {
+                        return m_pending == 0;
+                    });
+    m_task = nullptr;
+}
+
+void ThreadPool::workerLoop(std::size_t index)
+{
+    std::uint64_t seenGeneration = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workReady.wait(lock, [this, seenGeneration]
+                             {
+                                 return m_stopping || m_generation != seenGeneration;
+                             });
+            if (m_stopping)
+            {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        this->runRange(index);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_pending == 0)
+        {
+            m_workDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runRange(std::size_t index) const
+{
+    std::size_t threads = this->getThreadCount();
+    std::size_t begin = m_count * index / threads;
+    std::size_t end = m_count * (index + 1) / threads;
+
+    if (begin < end)
+    {
+        (*m_task)(begin, end);
+    }
+}
+
+void ThreadPool::parallelForEach(std::size_t count, const std::function<void(std::size_t, std::size_t)>& task)
+{
+    if (count > std::numeric_limits<std::uint32_t>::max())
+    {
+        throw std::invalid_argument("parallelForEach takes at most 2^32 - 1 items");
+    }
+
+    std::size_t threads = this->getThreadCount();
+    std::vector<StealRange> ranges(threads);
+    for (std::size_t thread = 0; thread < threads; thread++)
+    {
+        ranges[thread].bounds.store(packRange(count * thread / threads, count * (thread + 1) / threads));
+    }
+
+    // One index per thread, so every thread runs the loop below with its own range
+    this->parallelFor(threads, [&](std::size_t beginThread, std::size_t endThread)
+                      {
+                          for (std::size_t thread = beginThread; thread < endThread; thread++)
+                          {
+                              std::size_t index;
+                              std::size_t victim = 1;
+                              while (true)
+                              {
+                                  while (claimFront(ranges[thread], index))
+                                  {
+                                      task(index, thread);
+                                  }
+                                  // Anything still unclaimed belongs to a thread that is running and will finish it
+                                  while (victim < threads && !stealBack(ranges[(thread + victim) % threads], ranges[thread]))
+                                  {
+                                      victim++;
+                                  }
+                                  if (victim == threads)
+                                  {
+                                      break;
+                                  }
+                              }
+                          }
+                      });
+}
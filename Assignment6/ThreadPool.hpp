@@ -0,0 +1,42 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads that stay alive for the lifetime of the pool, so
+// dispatching work every generation does not pay for thread creation.
+class ThreadPool
+{
+  public:
+    ThreadPool(std::size_t threadCount);
+    ~ThreadPool();
+
+    std::size_t getThreadCount() const;
+
+    // Splits [0, count) into one contiguous range per thread and blocks until all of them are done.
+    // The calling thread processes the first range itself.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& task);
+    // Calls task(index, thread) once for every index in [0, count), for work items whose cost varies.
+    // Each thread starts on its own contiguous range and, once that is used up, steals the back half
+    // of another thread's range. Blocks until every index is done.
+    void parallelForEach(std::size_t count, const std::function<void(std::size_t, std::size_t)>& task);
+
+  private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_workReady;
+    std::condition_variable m_workDone;
+    const std::function<void(std::size_t, std::size_t)>* m_task = nullptr;
+    std::size_t m_count = 0;
+    std::uint64_t m_generation = 0;
+    std::size_t m_pending = 0;
+    bool m_stopping = false;
+
+    void workerLoop(std::size_t index);
+    void runRange(std::size_t index) const;
+};
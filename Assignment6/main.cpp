@@ -1,22 +1,143 @@
+#include "LifeFrameSlot.hpp"
 #include "LifeSimulator.hpp"
 #include "PatternAcorn.hpp"
+#include "PatternBitmap.hpp"
 #include "PatternBlinker.hpp"
 #include "PatternBlock.hpp"
 #include "PatternGlider.hpp"
 #include "PatternGosperGliderGun.hpp"
 #include "PatternPulsar.hpp"
 #include "RendererConsole.hpp"
+#include "RendererImage.hpp"
 #include "rlutil.h"
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <thread>
 
-int main()
+namespace
 {
+    const char* USAGE =
+        "Usage: ConwaysLife [pattern.rle|pattern.cells] [options]\n"
+        "  --fps N       frames drawn per second, 30 by default\n"
+        "  --gps N       generations per second, 100 by default; 0 runs as fast as possible\n"
+        "  --seconds N   how long to run, 10 by default\n"
+        "  --record F    also write every drawn frame to F, a multi-image .pgm or .ppm stream\n"
+        "  --scale N     pixels per cell in recorded frames, 4 by default\n"
+        "  --quiet       record without drawing to the terminal\n"
+        "  --size WxH    board size in cells; the terminal's size by default, or 160x90 with --quiet\n";
+
+    class Options
+    {
+      public:
+        std::string pattern;
+        double framesPerSecond = 30;
+        double generationsPerSecond = 100;
+        double seconds = 10;
+        std::string record;
+        std::uint32_t scale = 4;
+        bool quiet = false;
+        std::uint32_t sizeX = 0;
+        std::uint32_t sizeY = 0;
+    };
+
+    Options parseOptions(int argc, char* argv[])
+    {
+        Options options;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string option = argv[i];
+            if (option.rfind("--", 0) != 0)
+            {
+                options.pattern = option;
+                continue;
+            }
+            if (option == "--quiet")
+            {
+                options.quiet = true;
+                continue;
+            }
+            if (i + 1 >= argc)
+            {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+
+            if (option == "--record")
+            {
+                options.record = argv[++i];
+                continue;
+            }
+            if (option == "--size")
+            {
+                std::string size = argv[++i];
+                std::size_t separator = size.find('x');
+                options.sizeX = static_cast<std::uint32_t>(std::stoul(size.substr(0, separator)));
+                options.sizeY = separator == std::string::npos ? 0 : static_cast<std::uint32_t>(std::stoul(size.substr(separator + 1)));
+                if (options.sizeX == 0 || options.sizeY == 0)
+                {
+                    throw std::invalid_argument("Bad option --size " + size);
+                }
+                continue;
+            }
+
+            double value = std::stod(argv[++i]);
+            if (option == "--fps" && value > 0)
+            {
+                options.framesPerSecond = value;
+            }
+            else if (option == "--gps" && value >= 0)
+            {
+                options.generationsPerSecond = value;
+            }
+            else if (option == "--seconds" && value >= 0)
+            {
+                options.seconds = value;
+            }
+            else if (option == "--scale" && value >= 1)
+            {
+                options.scale = static_cast<std::uint32_t>(value);
+            }
+            else
+            {
+                throw std::invalid_argument("Bad option " + option + " " + argv[i]);
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    try
+    {
+        options = parseOptions(argc, argv);
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << "\n"
+                  << USAGE;
+        return 1;
+    }
+    if (options.quiet && options.record.empty())
+    {
+        std::cerr << "--quiet needs --record\n"
+                  << USAGE;
+        return 1;
+    }
+
     // Create a life simulator and renderer
-    LifeSimulator lifeSim(static_cast<std::uint8_t>(rlutil::trows()), static_cast<std::uint8_t>(rlutil::tcols()));
+    if (options.sizeX == 0)
+    {
+        options.sizeX = options.quiet ? 160 : static_cast<std::uint32_t>(rlutil::tcols());
+        options.sizeY = options.quiet ? 90 : static_cast<std::uint32_t>(rlutil::trows());
+    }
+    LifeSimulator lifeSim(options.sizeX, options.sizeY);
 
     PatternGlider glider;
     PatternPulsar pulsar;
@@ -25,22 +146,111 @@ int main()
     PatternAcorn accorn;
 
     RendererConsole render;
+    std::unique_ptr<RendererImage> recording;
+    if (!options.record.empty())
+    {
+        try
+        {
+            recording = std::make_unique<RendererImage>(options.record, options.scale, true);
+        }
+        catch (const std::exception& error)
+        {
+            std::cerr << error.what() << "\n"
+                      << USAGE;
+            return 1;
+        }
+    }
 
     lifeSim.insertPattern(glider, 3, 5);
     lifeSim.insertPattern(blinker, 5, 5);
     lifeSim.insertPattern(accorn, 13, 15);
     lifeSim.insertPattern(glider, 0, 0);
 
-    rlutil::hidecursor();
+    // A .rle or .cells file named on the command line is placed in the middle of the screen
+    if (!options.pattern.empty())
+    {
+        try
+        {
+            PatternBitmap pattern = PatternBitmap::load(options.pattern);
+            lifeSim.insertPattern(pattern, (lifeSim.getSizeX() - std::min(pattern.getSizeX(), lifeSim.getSizeX())) / 2, (lifeSim.getSizeY() - std::min(pattern.getSizeY(), lifeSim.getSizeY())) / 2);
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!options.quiet)
+    {
+        rlutil::hidecursor();
+    }
+
+    // The simulation steps on its own thread and publishes a generation whenever the last one has
+    // been taken; the loop below draws the newest at each tick, so a slow terminal never holds the
+    // simulation back and an unthrottled one does not copy boards that are never drawn
+    LifeFrameSlot frames;
+    frames.getWriteFrame().capture(lifeSim);
+    frames.publish();
+
+    std::atomic<bool> stopping = false;
+    std::thread simulation([&]()
+                           {
+                               auto start = std::chrono::steady_clock::now();
+                               while (!stopping.load(std::memory_order_relaxed))
+                               {
+                                   lifeSim.update();
+                                   if (frames.wantsFrame())
+                                   {
+                                       frames.getWriteFrame().capture(lifeSim);
+                                       frames.publish();
+                                   }
 
-    for (int i = 0; i < 1000; i++)
+                                   if (options.generationsPerSecond > 0)
+                                   {
+                                       std::this_thread::sleep_until(start + std::chrono::duration<double>(static_cast<double>(lifeSim.getGeneration()) / options.generationsPerSecond));
+                                   }
+                               }
+                           });
+
+    using Duration = std::chrono::steady_clock::duration;
+    auto frameTime = std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1 / options.framesPerSecond));
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration_cast<Duration>(std::chrono::duration<double>(options.seconds));
+    for (auto tick = std::chrono::steady_clock::now(); tick < end; tick += frameTime)
     {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        render.render(lifeSim);
-        lifeSim.update();
+        if (frames.takeLatest())
+        {
+            if (!options.quiet)
+            {
+                render.render(frames.getReadFrame());
+            }
+            if (recording)
+            {
+                recording->render(frames.getReadFrame());
+            }
+        }
+        std::this_thread::sleep_until(tick + frameTime);
     }
 
-    rlutil::cls();
+    stopping = true;
+    simulation.join();
+
+    if (!options.quiet)
+    {
+        rlutil::cls();
+    }
+    if (recording)
+    {
+        try
+        {
+            recording->wait();
+        }
+        catch (const std::runtime_error& error)
+        {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+    }
 
     return 0;
-}
\ No newline at end of file
+}